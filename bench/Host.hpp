@@ -0,0 +1,84 @@
+/*
+ * This file is part of VectorModular.
+ *
+ * VectorModular is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * VectorModular is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#pragma once
+
+//headless host for the plugin's modules, shared by the benchmark and the golden renders. it stands in for the
+//little of the rack engine a module sees: cables in its ports, the sample rate and process() once per sample.
+//the modules are compiled in here so their port and param ids can be used by name, everything else is the real
+//code from the plugin and libRack
+#include "../src/BaseOsc.cpp"
+#include "../src/SoloMixer.cpp"
+#include "../src/ThreeIx9o.cpp"
+#include "../src/baseTrigs.cpp"
+#include <functional>
+
+
+namespace host {
+
+//a cable into an input, or out of an output. the module sets the channels of its outputs itself once patched. like
+//the engine, the module hears about it right after
+inline void patch(Module* module, Input& input, int channels = 1) {
+	input.channels = channels;
+	Module::PortChangeEvent e;
+	e.connecting = true;
+	e.type = Port::INPUT;
+	e.portId = &input - module->inputs.data();
+	module->onPortChange(e);
+}
+
+inline void patch(Module* module, Output& output) {
+	output.channels = 1;
+	Module::PortChangeEvent e;
+	e.connecting = true;
+	e.type = Port::OUTPUT;
+	e.portId = &output - module->outputs.data();
+	module->onPortChange(e);
+}
+
+//called before every sample with the frame about to run, to set inputs and knobs
+typedef std::function<void(Module* module, int64_t frame, float sampleRate)> Driver;
+
+//runs frames samples, frame counts on from the last call. after is called once every sample was processed, to
+//record the outputs
+inline void run(Module* module, float sampleRate, int64_t frames, int64_t& frame, const Driver& driver, const Driver& after = NULL) {
+	//the engine sends the sample rate when a module is added and whenever it changes
+	Module::SampleRateChangeEvent e;
+	e.sampleRate = sampleRate;
+	e.sampleTime = 1.f / sampleRate;
+	module->onSampleRateChange(e);
+
+	Module::ProcessArgs args;
+	args.sampleRate = sampleRate;
+	args.sampleTime = 1.f / sampleRate;
+	for (int64_t end = frame + frames; frame < end; frame++) {
+		if (driver) {
+			driver(module, frame, sampleRate);
+		}
+		args.frame = frame;
+		module->process(args);
+		if (after) {
+			after(module, frame, sampleRate);
+		}
+	}
+}
+
+//a square clock at bpm with 50% duty, the way a clock module would send it
+inline float clock(int64_t frame, float sampleRate, float bpm) {
+	int64_t period = (int64_t) (sampleRate * 60.f / bpm);
+	return frame % period < period / 2 ? 10.f : 0.f;
+}
+
+}
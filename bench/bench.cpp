@@ -0,0 +1,174 @@
+/*
+ * This file is part of VectorModular.
+ *
+ * VectorModular is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * VectorModular is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ */
+
+
+//benchmark for every module outside of rack. each run patches a module like a real patch would, warms it up for a
+//tenth of a second and times process(). one csv line per run on stdout, so runs can be diffed and plotted:
+//module,config,sample_rate,channels,samples,ns_per_sample,samples_per_second,realtime
+//
+//usage: bench [samples per run, default 1000000] [module slug, default all]
+
+#include "Host.hpp"
+#include <chrono>
+
+
+struct Scenario {
+	std::string module;
+	std::string config;
+	int channels;
+	std::function<Module*(int channels)> create; //new module, patched
+	host::Driver driver;
+};
+
+static const float sampleRates[] = {44100.f, 48000.f, 96000.f, 192000.f};
+
+//slow steps on every v/oct channel, a few semitones apart so the voices don't all play the same note
+static void driveBaseOsc(Module* module, int64_t frame, float sampleRate) {
+	Input& voct = module->inputs[BaseOsc::VOCT_INPUT];
+	float step = (frame / 4800 % 24) / 12.f - 1.f;
+	for (int c = 0; c < voct.getChannels(); c++) {
+		voct.setVoltage(step + c * 0.25f, c);
+	}
+}
+
+static BaseOsc* createBaseOsc(int channels, bool allOutputs) {
+	BaseOsc* module = new BaseOsc;
+	host::patch(module, module->inputs[BaseOsc::VOCT_INPUT], channels);
+	if (allOutputs) {
+		for (int i = 0; i < BaseOsc::OUTPUTS_LEN; i++) {
+			host::patch(module, module->outputs[i]);
+		}
+	} else {
+		host::patch(module, module->outputs[BaseOsc::SAW_OUTPUT]);
+	}
+	return module;
+}
+
+static std::vector<Scenario> scenarios() {
+	std::vector<Scenario> list;
+
+	for (int channels : {1, 16}) {
+		list.push_back({"BaseOsc", "saw", channels, [](int channels) -> Module* {
+			return createBaseOsc(channels, false);
+		}, driveBaseOsc});
+		list.push_back({"BaseOsc", "all outputs", channels, [](int channels) -> Module* {
+			return createBaseOsc(channels, true);
+		}, driveBaseOsc});
+		list.push_back({"BaseOsc", "all outputs, braids shapes", channels, [](int channels) -> Module* {
+			BaseOsc* module = createBaseOsc(channels, true);
+			module->analogCore = BaseOsc::BRAIDS_CORE;
+			return module;
+		}, driveBaseOsc});
+		list.push_back({"BaseOsc", "all outputs, quantizer", channels, [](int channels) -> Module* {
+			BaseOsc* module = createBaseOsc(channels, true);
+			module->params[BaseOsc::QNTSCALE_PARAM].setValue(2);
+			return module;
+		}, driveBaseOsc});
+		list.push_back({"BaseOsc", "all outputs, lfo", channels, [](int channels) -> Module* {
+			BaseOsc* module = createBaseOsc(channels, true);
+			module->isLFOmode = true;
+			return module;
+		}, driveBaseOsc});
+		list.push_back({"BaseOsc", "quantizer only", channels, [](int channels) -> Module* {
+			BaseOsc* module = createBaseOsc(channels, true);
+			module->params[BaseOsc::QNTSCALE_PARAM].setValue(2);
+			module->quantizerOnly = true;
+			return module;
+		}, driveBaseOsc});
+	}
+
+	list.push_back({"baseTrigs", "internal clock", 1, [](int channels) -> Module* {
+		BaseTrigs* module = new BaseTrigs;
+		for (int i = 0; i < BaseTrigs::OUTPUTS_LEN; i++) {
+			host::patch(module, module->outputs[i]);
+		}
+		return module;
+	}, NULL});
+	list.push_back({"baseTrigs", "external clock", 1, [](int channels) -> Module* {
+		BaseTrigs* module = new BaseTrigs;
+		host::patch(module, module->inputs[BaseTrigs::CLOCK_TRIG_IN_INPUT]);
+		for (int i = 0; i < BaseTrigs::OUTPUTS_LEN; i++) {
+			host::patch(module, module->outputs[i]);
+		}
+		return module;
+	}, [](Module* module, int64_t frame, float sampleRate) {
+		module->inputs[BaseTrigs::CLOCK_TRIG_IN_INPUT].setVoltage(host::clock(frame, sampleRate, 120.f));
+	}});
+
+	list.push_back({"SoloMixer", "three inputs", 1, [](int channels) -> Module* {
+		SoloMixer* module = new SoloMixer;
+		for (int i = 0; i < SoloMixer::INPUTS_LEN; i++) {
+			host::patch(module, module->inputs[i]);
+		}
+		for (int i = 0; i < SoloMixer::OUTPUTS_LEN; i++) {
+			host::patch(module, module->outputs[i]);
+		}
+		module->params[SoloMixer::LEVELRED_PARAM].setValue(1.f);
+		module->params[SoloMixer::LEVELGREEN_PARAM].setValue(1.f);
+		module->params[SoloMixer::LEVELBLUE_PARAM].setValue(1.f);
+		module->params[SoloMixer::LEVELMIX_PARAM].setValue(1.f);
+		return module;
+	}, [](Module* module, int64_t frame, float sampleRate) {
+		for (int i = 0; i < SoloMixer::INPUTS_LEN; i++) {
+			module->inputs[i].setVoltage((frame + i * 37) % 100 * 0.1f - 5.f);
+		}
+	}});
+
+	list.push_back({"ThreeIx9o", "one input to nine", 1, [](int channels) -> Module* {
+		ThreeIx9o* module = new ThreeIx9o;
+		host::patch(module, module->inputs[ThreeIx9o::INPUT1_INPUT]);
+		for (int i = 0; i < ThreeIx9o::OUTPUTS_LEN; i++) {
+			host::patch(module, module->outputs[i]);
+		}
+		return module;
+	}, [](Module* module, int64_t frame, float sampleRate) {
+		module->inputs[ThreeIx9o::INPUT1_INPUT].setVoltage(frame % 100 * 0.1f - 5.f);
+	}});
+
+	return list;
+}
+
+
+int main(int argc, char** argv) {
+	int64_t samples = argc > 1 ? std::atoll(argv[1]) : 1000000;
+	std::string only = argc > 2 ? argv[2] : "";
+
+	random::init();
+
+	std::printf("module,config,sample_rate,channels,samples,ns_per_sample,samples_per_second,realtime\n");
+
+	for (const Scenario& scenario : scenarios()) {
+		if (!only.empty() && scenario.module != only) {
+			continue;
+		}
+
+		for (float sampleRate : sampleRates) {
+			Module* module = scenario.create(scenario.channels);
+			int64_t frame = 0;
+			host::run(module, sampleRate, sampleRate / 10, frame, scenario.driver);
+
+			auto start = std::chrono::steady_clock::now();
+			host::run(module, sampleRate, samples, frame, scenario.driver);
+			double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			delete module;
+
+			std::printf("%s,\"%s\",%.0f,%d,%lld,%.2f,%.0f,%.1f\n", scenario.module.c_str(), scenario.config.c_str(),
+				sampleRate, scenario.channels, (long long) samples, seconds * 1e9 / samples, samples / seconds,
+				samples / sampleRate / seconds);
+			std::fflush(stdout);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,531 @@
+/*
+ * This file is part of VectorModular.
+ *
+ * VectorModular is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * VectorModular is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ */
+
+
+//golden renders for every module. each render runs a module with scripted inputs and knob moves and records its
+//outputs, which are compared against the files in bench/golden within a tolerance. a change that is meant to leave
+//the sound alone can prove it does. the spectral checks measure the native shapes directly and need no files
+//
+//usage: golden [--update] [golden directory, default bench/golden]
+//--update writes the current renders as the new goldens. renders are only comparable with goldens from the same
+//sample rate and script, so update them together with any change to this file
+
+#include "Host.hpp"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <pffft.h>
+
+
+static const float SAMPLE_RATE = 48000.f;
+static const float AUDIO_TOLERANCE = 1e-3f; //volts, leaves room for other compilers and instruction sets
+static const int EDGE_TOLERANCE = 2; //samples
+
+static int failures = 0;
+static int skipped = 0;
+
+static void report(bool ok, const std::string& name, const std::string& detail) {
+	std::printf("%s %s: %s\n", ok ? "ok  " : "FAIL", name.c_str(), detail.c_str());
+	if (!ok) {
+		failures++;
+	}
+}
+
+//a render without a golden yet is not a regression, it is listed so nobody mistakes it for a pass
+static void skip(const std::string& name, const std::string& detail) {
+	std::printf("SKIP %s: %s\n", name.c_str(), detail.c_str());
+	skipped++;
+}
+
+
+//outputs recorded after every sample, interleaved
+struct Recording {
+	std::vector<std::pair<int, int>> ports; //output and channel
+	std::vector<float> data;
+
+	host::Driver recorder() {
+		return [this](Module* module, int64_t frame, float sampleRate) {
+			for (size_t i = 0; i < ports.size(); i++) {
+				data.push_back(module->outputs[ports[i].first].getVoltage(ports[i].second));
+			}
+		};
+	}
+};
+
+//32 bit float wav, so goldens open in any audio editor
+static bool writeWav(const std::string& path, const Recording& recording) {
+	std::ofstream file(path, std::ios::binary);
+	if (!file) {
+		return false;
+	}
+	auto write32 = [&](uint32_t value) {file.write((const char*) &value, 4);};
+	auto write16 = [&](uint16_t value) {file.write((const char*) &value, 2);};
+
+	uint16_t channels = recording.ports.size();
+	uint32_t dataBytes = recording.data.size() * sizeof(float);
+	file.write("RIFF", 4);
+	write32(36 + dataBytes);
+	file.write("WAVEfmt ", 8);
+	write32(16);
+	write16(3); //float
+	write16(channels);
+	write32(SAMPLE_RATE);
+	write32(SAMPLE_RATE * channels * sizeof(float));
+	write16(channels * sizeof(float));
+	write16(32);
+	file.write("data", 4);
+	write32(dataBytes);
+	file.write((const char*) recording.data.data(), dataBytes);
+	return (bool) file;
+}
+
+//reads back what writeWav wrote, nothing else
+static bool readWav(const std::string& path, int& channels, std::vector<float>& data) {
+	std::ifstream file(path, std::ios::binary);
+	char header[44];
+	if (!file.read(header, sizeof(header)) || std::memcmp(header, "RIFF", 4) != 0 || std::memcmp(header + 36, "data", 4) != 0) {
+		return false;
+	}
+	uint16_t channels16;
+	uint32_t dataBytes;
+	std::memcpy(&channels16, header + 22, 2);
+	std::memcpy(&dataBytes, header + 40, 4);
+	channels = channels16;
+	data.resize(dataBytes / sizeof(float));
+	return (bool) file.read((char*) data.data(), dataBytes);
+}
+
+static void compareAudio(const std::string& directory, bool update, const std::string& name, const Recording& recording) {
+	std::string path = directory + "/" + name + ".wav";
+	if (update) {
+		report(writeWav(path, recording), name, "written to " + path);
+		return;
+	}
+
+	int channels;
+	std::vector<float> golden;
+	if (!readWav(path, channels, golden)) {
+		skip(name, "no golden at " + path + ", run make golden on a known good build");
+		return;
+	}
+	if (channels != (int) recording.ports.size() || golden.size() != recording.data.size()) {
+		report(false, name, "golden has a different length or channel count, the script changed");
+		return;
+	}
+
+	float worst = 0.f;
+	size_t worstIndex = 0;
+	for (size_t i = 0; i < golden.size(); i++) {
+		float error = std::fabs(golden[i] - recording.data[i]);
+		if (!(error <= worst)) {
+			worst = error;
+			worstIndex = i;
+		}
+	}
+	report(worst <= AUDIO_TOLERANCE, name, string::f("max error %g V at frame %d, channel %d", worst,
+		(int) (worstIndex / channels), (int) (worstIndex % channels)));
+}
+
+
+//rising and falling edges of gate outputs. triggers are compared by when they happen, which stays readable in a
+//diff and doesn't need seconds of audio in the repository
+struct Edges {
+	std::vector<int> outputs;
+	std::vector<float> last;
+	std::vector<std::vector<int64_t>> frames; //per output, rise and fall alternating
+
+	host::Driver recorder() {
+		last.assign(outputs.size(), 0.f);
+		frames.assign(outputs.size(), std::vector<int64_t>());
+		return [this](Module* module, int64_t frame, float sampleRate) {
+			for (size_t i = 0; i < outputs.size(); i++) {
+				float voltage = module->outputs[outputs[i]].getVoltage();
+				if ((voltage >= 1.f) != (last[i] >= 1.f)) {
+					frames[i].push_back(frame);
+				}
+				last[i] = voltage;
+			}
+		};
+	}
+};
+
+static void compareEdges(const std::string& directory, bool update, const std::string& name, const Edges& edges) {
+	std::string path = directory + "/" + name + ".txt";
+	if (update) {
+		std::ofstream file(path);
+		file << "# one line per output: output id, then the frames of its rising and falling edges\n";
+		for (size_t i = 0; i < edges.outputs.size(); i++) {
+			file << edges.outputs[i];
+			for (int64_t frame : edges.frames[i]) {
+				file << " " << frame;
+			}
+			file << "\n";
+		}
+		report((bool) file, name, "written to " + path);
+		return;
+	}
+
+	std::ifstream file(path);
+	if (!file) {
+		skip(name, "no golden at " + path + ", run make golden on a known good build");
+		return;
+	}
+
+	std::string line;
+	size_t i = 0;
+	while (std::getline(file, line)) {
+		if (line.empty() || line[0] == '#') {
+			continue;
+		}
+		std::istringstream words(line);
+		int output;
+		words >> output;
+		std::vector<int64_t> golden;
+		int64_t frame;
+		while (words >> frame) {
+			golden.push_back(frame);
+		}
+
+		if (i >= edges.outputs.size() || edges.outputs[i] != output) {
+			report(false, name, "golden lists other outputs, the script changed");
+			return;
+		}
+		const std::vector<int64_t>& rendered = edges.frames[i];
+		if (rendered.size() != golden.size()) {
+			report(false, name, string::f("output %d has %d edges, golden has %d", output, (int) rendered.size(), (int) golden.size()));
+			return;
+		}
+		for (size_t k = 0; k < golden.size(); k++) {
+			if (std::abs(rendered[k] - golden[k]) > EDGE_TOLERANCE) {
+				report(false, name, string::f("output %d edge %d at frame %lld, golden %lld", output, (int) k,
+					(long long) rendered[k], (long long) golden[k]));
+				return;
+			}
+		}
+		i++;
+	}
+	report(i == edges.outputs.size(), name, string::f("%d outputs within %d samples", (int) i, EDGE_TOLERANCE));
+}
+
+
+static float seconds(float s) {
+	return s * SAMPLE_RATE;
+}
+
+//steps through a few notes, the second voice a few semitones above the first. pwm and index mod run slow lfos
+static void driveBaseOsc(Module* module, int64_t frame, float sampleRate) {
+	static const float notes[] = {0.f, 7 / 12.f, -5 / 12.f, 1.f};
+	float t = frame / sampleRate;
+	float note = notes[(int) (t / 0.05f) % 4];
+	module->inputs[BaseOsc::VOCT_INPUT].setVoltage(note, 0);
+	module->inputs[BaseOsc::VOCT_INPUT].setVoltage(note + 0.25f, 1);
+	module->inputs[BaseOsc::PWM_INPUT].setVoltage(5.f * std::sin(2.f * M_PI * 3.f * t));
+	module->inputs[BaseOsc::INDEXMOD_INPUT].setVoltage(10.f * std::fabs(std::fmod(t * 4.f, 2.f) - 1.f) - 5.f);
+}
+
+static BaseOsc* createBaseOsc() {
+	BaseOsc* module = new BaseOsc;
+	module->fixedNoiseSeed = true;
+	module->noiseSeed = 1;
+	module->seedNoise();
+	host::patch(module, module->inputs[BaseOsc::VOCT_INPUT], 2);
+	host::patch(module, module->inputs[BaseOsc::PWM_INPUT]);
+	host::patch(module, module->inputs[BaseOsc::INDEXMOD_INPUT]);
+	module->params[BaseOsc::PWMAMT_PARAM].setValue(0.5f);
+	module->params[BaseOsc::INDEXMODAMT_PARAM].setValue(0.5f);
+	return module;
+}
+
+static Recording recordAll(BaseOsc* module, std::initializer_list<int> outputs) {
+	Recording recording;
+	for (int output : outputs) {
+		host::patch(module, module->outputs[output]);
+		recording.ports.push_back(std::make_pair(output, 0));
+	}
+	return recording;
+}
+
+static void renderBaseOsc(const std::string& directory, bool update) {
+
+	//native shapes, sub, noise and the braids engines that are always braids
+	{
+		BaseOsc* module = createBaseOsc();
+		Recording recording = recordAll(module, {BaseOsc::TRI_OUTPUT, BaseOsc::SAW_OUTPUT, BaseOsc::PULSE_OUTPUT,
+			BaseOsc::SINE_OUTPUT, BaseOsc::SUBSQUARE_OUTPUT, BaseOsc::WAVETABLE_OUTPUT, BaseOsc::NOISE_OUTPUT,
+			BaseOsc::PITCHEDNOISE_OUTPUT, BaseOsc::CLOCKEDNOISE_OUTPUT});
+		recording.ports.push_back(std::make_pair((int) BaseOsc::SAW_OUTPUT, 1));
+		int64_t frame = 0;
+		host::run(module, SAMPLE_RATE, seconds(0.25f), frame, driveBaseOsc, recording.recorder());
+		delete module;
+		compareAudio(directory, update, "baseosc_outputs", recording);
+	}
+
+	//the braids shapes through the resampler, with the bits knob down
+	{
+		BaseOsc* module = createBaseOsc();
+		module->analogCore = BaseOsc::BRAIDS_CORE;
+		module->params[BaseOsc::BITS_PARAM].setValue(6.f);
+		Recording recording = recordAll(module, {BaseOsc::TRI_OUTPUT, BaseOsc::SAW_OUTPUT, BaseOsc::PULSE_OUTPUT,
+			BaseOsc::SINE_OUTPUT, BaseOsc::WAVETABLE_OUTPUT});
+		int64_t frame = 0;
+		host::run(module, SAMPLE_RATE, seconds(0.25f), frame, driveBaseOsc, recording.recorder());
+		delete module;
+		compareAudio(directory, update, "baseosc_braids", recording);
+	}
+
+	//lfo mode, hard synced five times a second
+	{
+		BaseOsc* module = createBaseOsc();
+		module->isLFOmode = true;
+		host::patch(module, module->inputs[BaseOsc::SYNC_INPUT]);
+		Recording recording = recordAll(module, {BaseOsc::TRI_OUTPUT, BaseOsc::SAW_OUTPUT, BaseOsc::PULSE_OUTPUT,
+			BaseOsc::SINE_OUTPUT, BaseOsc::SUBSQUARE_OUTPUT, BaseOsc::WAVETABLE_OUTPUT, BaseOsc::PITCHEDNOISE_OUTPUT});
+		int64_t frame = 0;
+		host::run(module, SAMPLE_RATE, seconds(0.5f), frame, [](Module* module, int64_t frame, float sampleRate) {
+			driveBaseOsc(module, frame, sampleRate);
+			module->inputs[BaseOsc::VOCT_INPUT].setVoltage(3.f, 0);
+			module->inputs[BaseOsc::SYNC_INPUT].setVoltage(host::clock(frame, sampleRate, 300.f));
+		}, recording.recorder());
+		delete module;
+
+		//every lfo shape swings between -5V and 5V, whatever the goldens say
+		float peak = 0.f;
+		int peakOutput = 0;
+		for (size_t i = 0; i < recording.data.size(); i++) {
+			if (std::fabs(recording.data[i]) > peak) {
+				peak = std::fabs(recording.data[i]);
+				peakOutput = recording.ports[i % recording.ports.size()].first;
+			}
+		}
+		report(peak <= 5.f + AUDIO_TOLERANCE, "baseosc_lfo_range", string::f("peak %g V on output %d", peak, peakOutput));
+
+		compareAudio(directory, update, "baseosc_lfo", recording);
+	}
+
+	//quantizer sweep over two octaves, scale and root change half way
+	{
+		BaseOsc* module = createBaseOsc();
+		module->params[BaseOsc::QNTSCALE_PARAM].setValue(2.f);
+		Recording recording = recordAll(module, {BaseOsc::QUANTIZED_OUTPUT, BaseOsc::SINE_OUTPUT});
+		int64_t frame = 0;
+		host::Driver sweep = [](Module* module, int64_t frame, float sampleRate) {
+			module->inputs[BaseOsc::VOCT_INPUT].setVoltage(-1.f + 2.f * frame / seconds(0.5f), 0);
+		};
+		host::run(module, SAMPLE_RATE, seconds(0.25f), frame, sweep, recording.recorder());
+
+		//every note of the first half has to be in c major
+		static const bool major[12] = {true, false, true, false, true, true, false, true, false, true, false, true};
+		int offScale = 0;
+		for (size_t i = 0; i < recording.data.size(); i += 2) {
+			float semitones = recording.data[i] * 12.f;
+			int note = (int) std::round(semitones);
+			if (std::fabs(semitones - note) > 1e-3f || !major[eucMod(note, 12)]) {
+				offScale++;
+			}
+		}
+		report(offScale == 0, "baseosc_quantizer_scale", string::f("%d samples off the c major scale", offScale));
+
+		module->params[BaseOsc::QNTSCALE_PARAM].setValue(5.f);
+		module->params[BaseOsc::QNTROOT_PARAM].setValue(3.f);
+		host::run(module, SAMPLE_RATE, seconds(0.25f), frame, sweep, recording.recorder());
+		delete module;
+		compareAudio(directory, update, "baseosc_quantizer", recording);
+	}
+}
+
+//fundamental of a shape against the pitch it plays, and the loudest bin that is no harmonic of it, which is
+//aliasing. a 4 term blackman-harris window keeps the leakage of the harmonics out of the measurement. the alias
+//limits sit a few dB under what the shapes measure today, so they catch a change that makes it worse
+static void checkSpectrum(const std::string& name, int analogCore, int output, float frequency, float maxCents, float maxAliasDb) {
+	const int N = 16384;
+
+	BaseOsc module;
+	module.analogCore = analogCore;
+	host::patch(&module, module.inputs[BaseOsc::VOCT_INPUT]);
+	host::patch(&module, module.outputs[output]);
+	module.inputs[BaseOsc::VOCT_INPUT].setVoltage(std::log2(frequency / dsp::FREQ_C4));
+
+	Recording recording;
+	recording.ports.push_back(std::make_pair(output, 0));
+	int64_t frame = 0;
+	host::run(&module, SAMPLE_RATE, seconds(0.1f), frame, NULL);
+	host::run(&module, SAMPLE_RATE, N, frame, NULL, recording.recorder());
+
+	float* in = (float*) pffft_aligned_malloc(N * sizeof(float));
+	float* out = (float*) pffft_aligned_malloc(N * sizeof(float));
+	for (int i = 0; i < N; i++) {
+		float x = 2.f * M_PI * i / N;
+		float window = 0.35875f - 0.48829f * std::cos(x) + 0.14128f * std::cos(2.f * x) - 0.01168f * std::cos(3.f * x);
+		in[i] = recording.data[i] * window;
+	}
+	dsp::RealFFT fft(N);
+	fft.rfft(in, out);
+
+	std::vector<float> magnitude(N / 2);
+	for (int k = 1; k < N / 2; k++) {
+		magnitude[k] = std::hypot(out[2 * k], out[2 * k + 1]);
+	}
+	pffft_aligned_free(in);
+	pffft_aligned_free(out);
+
+	//the peak near the fundamental, refined with a parabola through the log magnitudes
+	float bin = SAMPLE_RATE / N;
+	int peak = frequency / bin;
+	for (int k = frequency * 0.9f / bin; k <= frequency * 1.1f / bin; k++) {
+		if (magnitude[k] > magnitude[peak]) {
+			peak = k;
+		}
+	}
+	float a = std::log(magnitude[peak - 1]), b = std::log(magnitude[peak]), c = std::log(magnitude[peak + 1]);
+	float measured = (peak + 0.5f * (a - c) / (a - 2.f * b + c)) * bin;
+	float cents = 1200.f * std::log2(measured / frequency);
+	report(std::fabs(cents) <= maxCents, name + "_pitch", string::f("%.1f Hz measured for %.1f Hz, %.3f cents", measured, frequency, cents));
+
+	if (maxAliasDb >= 0.f) {
+		return;
+	}
+	float alias = 0.f;
+	for (int k = 8; k < N / 2; k++) {
+		float harmonic = std::round(k * bin / frequency) * frequency;
+		if (harmonic > 0.f && std::fabs(k * bin - harmonic) < 6.f * bin) {
+			continue;
+		}
+		alias = std::max(alias, magnitude[k]);
+	}
+	float aliasDb = 20.f * std::log10(alias / magnitude[peak]);
+	report(aliasDb <= maxAliasDb, name + "_aliasing", string::f("loudest alias %.1f dB below the fundamental, limit %.0f dB", -aliasDb, -maxAliasDb));
+}
+
+static void renderBaseTrigs(const std::string& directory, bool update) {
+
+	Edges edges;
+	for (int i = 0; i < BaseTrigs::DIVISION_OUTPUTS_LEN; i++) {
+		edges.outputs.push_back(i);
+	}
+
+	//internal clock at the default tempo
+	{
+		BaseTrigs module;
+		for (int output : edges.outputs) {
+			host::patch(&module, module.outputs[output]);
+		}
+		int64_t frame = 0;
+		host::run(&module, SAMPLE_RATE, seconds(8.f), frame, NULL, edges.recorder());
+		compareEdges(directory, update, "basetrigs_internal", edges);
+	}
+
+	//external clock at 120 then 150 bpm, with a reset half way through the faster part
+	{
+		BaseTrigs module;
+		for (int output : edges.outputs) {
+			host::patch(&module, module.outputs[output]);
+		}
+		host::patch(&module, module.inputs[BaseTrigs::CLOCK_TRIG_IN_INPUT]);
+		host::patch(&module, module.inputs[BaseTrigs::RESET_TRIG_IN_INPUT]);
+		int64_t frame = 0;
+		host::run(&module, SAMPLE_RATE, seconds(12.f), frame, [](Module* module, int64_t frame, float sampleRate) {
+			float bpm = frame < seconds(6.f) ? 120.f : 150.f;
+			module->inputs[BaseTrigs::CLOCK_TRIG_IN_INPUT].setVoltage(host::clock(frame, sampleRate, bpm));
+			bool reset = frame >= seconds(9.f) && frame < seconds(9.001f);
+			module->inputs[BaseTrigs::RESET_TRIG_IN_INPUT].setVoltage(reset ? 10.f : 0.f);
+		}, edges.recorder());
+		compareEdges(directory, update, "basetrigs_external", edges);
+	}
+}
+
+//a button held for 10ms, long enough for a control block to see it
+static float button(int64_t frame, float at) {
+	return frame >= seconds(at) && frame < seconds(at + 0.01f) ? 1.f : 0.f;
+}
+
+static void renderSoloMixer(const std::string& directory, bool update) {
+	SoloMixer module;
+	Recording recording;
+	for (int i = 0; i < SoloMixer::INPUTS_LEN; i++) {
+		host::patch(&module, module.inputs[i]);
+	}
+	for (int i = 0; i < SoloMixer::OUTPUTS_LEN; i++) {
+		host::patch(&module, module.outputs[i]);
+		recording.ports.push_back(std::make_pair(i, 0));
+	}
+	module.params[SoloMixer::LEVELRED_PARAM].setValue(1.f);
+	module.params[SoloMixer::LEVELGREEN_PARAM].setValue(0.7f);
+	module.params[SoloMixer::LEVELBLUE_PARAM].setValue(1.2f);
+	module.params[SoloMixer::LEVELMIX_PARAM].setValue(-0.8f);
+
+	//solo red, flip to the second solo set, solo green there, flip back
+	int64_t frame = 0;
+	host::run(&module, SAMPLE_RATE, seconds(0.3f), frame, [](Module* module, int64_t frame, float sampleRate) {
+		float t = frame / sampleRate;
+		module->inputs[SoloMixer::RED_INPUT].setVoltage(5.f * std::sin(2.f * M_PI * 110.f * t));
+		module->inputs[SoloMixer::GREEN_INPUT].setVoltage(10.f * std::fmod(t * 220.f, 1.f) - 5.f);
+		module->inputs[SoloMixer::BLUE_INPUT].setVoltage(3.f);
+		module->params[SoloMixer::SOLORED_PARAM].setValue(button(frame, 0.05f));
+		module->params[SoloMixer::SOLOTOGGLE_PARAM].setValue(button(frame, 0.1f) + button(frame, 0.2f));
+		module->params[SoloMixer::SOLOGREEN_PARAM].setValue(button(frame, 0.15f));
+	}, recording.recorder());
+	compareAudio(directory, update, "solomixer", recording);
+}
+
+static void renderThreeIx9o(const std::string& directory, bool update) {
+	ThreeIx9o module;
+	Recording recording;
+	host::patch(&module, module.inputs[ThreeIx9o::INPUT1_INPUT]);
+	host::patch(&module, module.inputs[ThreeIx9o::INPUT3_INPUT]);
+	for (int i = 0; i < ThreeIx9o::OUTPUTS_LEN; i++) {
+		host::patch(&module, module.outputs[i]);
+		recording.ports.push_back(std::make_pair(i, 0));
+	}
+
+	//the second input is left open, so it gets the first one through the normalling
+	int64_t frame = 0;
+	host::run(&module, SAMPLE_RATE, seconds(0.05f), frame, [](Module* module, int64_t frame, float sampleRate) {
+		module->inputs[ThreeIx9o::INPUT1_INPUT].setVoltage(frame % 480 / 48.f - 5.f);
+		module->inputs[ThreeIx9o::INPUT3_INPUT].setVoltage(8.f * std::sin(2.f * M_PI * 50.f * frame / sampleRate));
+	}, recording.recorder());
+	compareAudio(directory, update, "threeix9o", recording);
+}
+
+
+int main(int argc, char** argv) {
+	bool update = false;
+	std::string directory = "bench/golden";
+	for (int i = 1; i < argc; i++) {
+		if (std::string(argv[i]) == "--update") {
+			update = true;
+		} else {
+			directory = argv[i];
+		}
+	}
+
+	random::init();
+
+	//the order matters, the braids noise engines share one random generator
+	renderBaseOsc(directory, update);
+	renderBaseTrigs(directory, update);
+	renderSoloMixer(directory, update);
+	renderThreeIx9o(directory, update);
+
+	checkSpectrum("baseosc_saw", BaseOsc::NATIVE_CORE, BaseOsc::SAW_OUTPUT, 440.f, 0.5f, -36.f);
+	checkSpectrum("baseosc_saw_high", BaseOsc::NATIVE_CORE, BaseOsc::SAW_OUTPUT, 3520.f, 0.5f, -18.f);
+	checkSpectrum("baseosc_pulse_high", BaseOsc::NATIVE_CORE, BaseOsc::PULSE_OUTPUT, 3520.f, 0.5f, -18.f);
+	checkSpectrum("baseosc_tri_high", BaseOsc::NATIVE_CORE, BaseOsc::TRI_OUTPUT, 3520.f, 0.5f, -35.f);
+	checkSpectrum("baseosc_sine", BaseOsc::NATIVE_CORE, BaseOsc::SINE_OUTPUT, 440.f, 0.5f, -80.f);
+	//braids pitch goes through its own tables and the resampler, only the pitch is checked
+	checkSpectrum("baseosc_braids_saw", BaseOsc::BRAIDS_CORE, BaseOsc::SAW_OUTPUT, 440.f, 2.f, 0.f);
+
+	std::printf("%d failed, %d skipped\n", failures, skipped);
+	return failures > 0;
+}
@@ -16,13 +16,148 @@
 #include "plugin.hpp"
 #include <cmath>
 #include "braids/macro_oscillator.h"
-#include "braids/quantizer.h"
 #include "braids/quantizer_scales.h"
+#include "Quantizer.hpp"
+#include "Scala.hpp"
+#include "Wavetable.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <osdialog.h>
 #include <string>
+#include <thread>
 #include <vector>
 
 
-struct BaseOsc : Module {
+//waves the lfo engine morphs through on the wavetable output. built once and shared by every instance
+struct LfoWavetable {
+	static const int WAVES = 8;
+	static const int SIZE = 256;
+
+	float waves[WAVES][SIZE + 1]; //one extra sample so interpolation never wraps
+
+	LfoWavetable() {
+		for (int i = 0; i <= SIZE; i++) {
+			float phase = (float) i / SIZE;
+			float sine = std::sin(2.f * M_PI * phase);
+			waves[0][i] = sine;
+			waves[1][i] = phase < 0.5f ? 4.f * phase - 1.f : 3.f - 4.f * phase; //triangle
+			waves[2][i] = 2.f * phase - 1.f; //ramp up
+			waves[3][i] = 1.f - 2.f * phase; //ramp down
+			waves[4][i] = std::tanh(4.f * sine) / std::tanh(4.f); //rounded square
+			waves[5][i] = 2.f * std::exp(-5.f * phase) - 1.f; //decay
+			waves[6][i] = 2.f * std::abs(sine) - 1.f; //two bumps
+			waves[7][i] = (sine + std::sin(6.f * M_PI * phase) / 3.f) / 0.943f; //sine plus third harmonic, about +/-1
+		}
+	}
+
+	static const LfoWavetable& get() {
+		static LfoWavetable table;
+		return table;
+	}
+
+	//position 0-1 morphs across the waves, phase 0-1 reads along them
+	float read(float position, float phase) const {
+		float w = position * (WAVES - 1);
+		int w0 = std::min((int) w, WAVES - 2);
+		float wf = w - w0;
+		float x = phase * SIZE;
+		int x0 = std::min((int) x, SIZE - 1);
+		float xf = x - x0;
+		float a = waves[w0][x0] + (waves[w0][x0 + 1] - waves[w0][x0]) * xf;
+		float b = waves[w0 + 1][x0] + (waves[w0 + 1][x0 + 1] - waves[w0 + 1][x0]) * xf;
+		return a + (b - a) * wf;
+	}
+};
+
+
+//plugin-wide free list, shared by every baseOsc. whatever one module gives back is handed to the next one that needs
+//it, so connecting an output rarely has to allocate. the list only grows to the most objects a patch used at once.
+//only used off the audio thread, where the rigs are built
+template <typename T>
+struct EnginePool {
+	std::mutex mutex;
+	std::vector<T*> freeList;
+
+	T* acquire() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (!freeList.empty()) {
+				T* object = freeList.back();
+				freeList.pop_back();
+				return object;
+			}
+		}
+		return new T;
+	}
+
+	void release(T* object) {
+		std::lock_guard<std::mutex> lock(mutex);
+		freeList.push_back(object);
+	}
+
+	static EnginePool& get() {
+		static EnginePool pool;
+		return pool;
+	}
+};
+
+//plugin-wide thread for the engine work that can't wait for a cable or menu event: engines for voices the channels
+//grew into, engines whose grace time ran out, and rigs the audio threads are done with. every baseOsc adds a task
+//and takes it out again before it goes away
+struct EngineWorker {
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::map<void*, std::function<void()>> tasks;
+	std::thread thread;
+	bool stopping = false;
+
+	void add(void* owner, std::function<void()> task) {
+		std::lock_guard<std::mutex> lock(mutex);
+		tasks[owner] = task;
+		if (!thread.joinable()) {
+			thread = std::thread([this]() {run();});
+		}
+	}
+
+	//the tasks run with the mutex held, so once this returns the owner's task is not running and never will again
+	void remove(void* owner) {
+		std::lock_guard<std::mutex> lock(mutex);
+		tasks.erase(owner);
+	}
+
+	void run() {
+		std::unique_lock<std::mutex> lock(mutex);
+		while (!stopping) {
+			for (auto& task : tasks) {
+				task.second();
+			}
+			wake.wait_for(lock, std::chrono::milliseconds(20));
+		}
+	}
+
+	~EngineWorker() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		wake.notify_one();
+		if (thread.joinable()) {
+			thread.join();
+		}
+	}
+
+	static EngineWorker& get() {
+		static EngineWorker worker;
+		return worker;
+	}
+};
+
+
+struct BaseOsc : ControlRateModule {
 	enum ParamId {
 		QNTSCALE_PARAM,
 		OCTUP_PARAM,
@@ -45,6 +180,7 @@ struct BaseOsc : Module {
 		FM_INPUT,
 		PWM_INPUT,
 		INDEXMOD_INPUT,
+		SYNC_INPUT,
 		INPUTS_LEN
 	};
 	enum OutputId {
@@ -57,6 +193,7 @@ struct BaseOsc : Module {
 		NOISE_OUTPUT,
 		PITCHEDNOISE_OUTPUT,
 		CLOCKEDNOISE_OUTPUT,
+		QUANTIZED_OUTPUT,
 		OUTPUTS_LEN
 	};
 	enum LightId {
@@ -91,54 +228,206 @@ struct BaseOsc : Module {
 		LIGHTS_LEN
 	};
 
-	//quantizer
-	braids::Quantizer quantizer;
+	//polyphony. the voice count follows the channels of the V/Oct input
+	static const int MAX_VOICES = 16;
+	int channels = 1;
+
+	//pitched outputs share one render engine per voice. this is the order they are packed in
+	enum EngineId {
+		TRI_ENGINE,
+		SAW_ENGINE,
+		PULSE_ENGINE,
+		SINE_ENGINE,
+		WAVETABLE_ENGINE,
+		PITCHEDNOISE_ENGINE,
+		CLOCKEDNOISE_ENGINE,
+		SUB_ENGINE, //only with the braids shapes, the native core derives the sub from its own phase
+		ENGINES_LEN
+	};
+
+	const int engineOutputs[ENGINES_LEN] = {
+		TRI_OUTPUT,
+		SAW_OUTPUT,
+		PULSE_OUTPUT,
+		SINE_OUTPUT,
+		WAVETABLE_OUTPUT,
+		PITCHEDNOISE_OUTPUT,
+		CLOCKEDNOISE_OUTPUT,
+		SUBSQUARE_OUTPUT
+	};
+
+	const braids::MacroOscillatorShape engineShapes[ENGINES_LEN] = {
+		braids::MACRO_OSC_SHAPE_MORPH,
+		braids::MACRO_OSC_SHAPE_MORPH,
+		braids::MACRO_OSC_SHAPE_SAW_SQUARE,
+		braids::MACRO_OSC_SHAPE_HARMONICS,
+		braids::MACRO_OSC_SHAPE_WAVE_LINE,
+		braids::MACRO_OSC_SHAPE_FILTERED_NOISE,
+		braids::MACRO_OSC_SHAPE_CLOCKED_NOISE,
+		braids::MACRO_OSC_SHAPE_SAW_SQUARE
+	};
+
+	//one braids engine of one voice: the oscillator, its own converter down from 96khz and the converted samples. an
+	//engine keeps running the same way while other outputs are patched and unpatched around it
+	struct Engine {
+		braids::MacroOscillator osc;
+		dsp::SampleRateConverter<1> src;
+		dsp::DoubleRingBuffer<dsp::Frame<1>, 256> outputBuffer;
+
+		//sync edges for the next block. syncTime counts 96khz samples since the last render
+		uint8_t syncBuffer[24] = {};
+		float syncTime = 0.f;
+
+		//for the thread building the rigs only
+		int srcQuality = -1;
+		float sampleRate = 0.f;
+		double idleSince = -1.0; //when the engine was last used, -1 while it is
+	};
+
+	//the engines of every voice, with the connected ones in output order. a rig is built whole off the audio thread,
+	//whenever a cable, the sample rate, a menu setting or the channel count changes what it needs, and handed over at
+	//control rate. the audio thread never allocates, locks or sets up a converter. engines that were unpatched or
+	//are past the channel count stay in the rig, idle, for the grace time
+	struct Rig {
+		int activeEngines[ENGINES_LEN] = {};
+		int numActiveEngines = 0;
+		int numVoices = 0; //voices with engines for the connected outputs
+		Engine* engines[MAX_VOICES][ENGINES_LEN] = {};
+		std::shared_ptr<const UserWavetable> wavetable; //comes with the engines that go with it, NULL for the braids tables
+		Rig* nextRetired = NULL;
+	};
+
+	Rig* rig = NULL; //audio thread only
+	std::atomic<Rig*> pendingRig{NULL}; //built, not picked up yet
+	std::atomic<Rig*> retiredRigs{NULL}; //no longer used by the audio thread, freed by the worker
+	std::atomic<int> channelsInUse{1}; //from the audio thread, so the worker can build voices the channels grew into
+
+	//everything below is for the threads building the rigs
+	std::mutex rigMutex;
+	std::vector<Rig*> rigs; //every rig that is not freed yet, the newest last
+	float engineSampleRate = 44100.f;
+
+	//an engine that stays unused this long goes back to the pool. replugging a cable within it keeps the oscillator
+	const double ENGINE_GRACE_TIME = 2.0;
+
+	//tri, saw, pulse and sine can also come from a band-limited core that runs straight at the engine sample rate, so
+	//they skip the 96khz render and the converter. the sub output always comes from that core's phase
+	enum AnalogCoreMode {
+		BRAIDS_CORE,
+		NATIVE_CORE,
+		ANALOG_CORES_LEN
+	};
+
+	//phases for four voices at a time. cycles counts the last four wraps of the phase, so the sub can be worked out
+	//from it. a loaded wavetable runs its own phase
+	struct AnalogCore {
+		float_4 phase = 0.f;
+		float_4 cycles = 0.f;
+		float_4 wavetablePhase = 0.f;
+	};
+
+	AnalogCore analogCores[MAX_VOICES / 4];
+	bool analogCoreActive = false; //one of the outputs the core feeds is patched
+
+	//the sub output divides or multiplies the main phase, so it stays in phase with the other shapes and costs next to
+	//nothing
+	enum SubShape {
+		SUB_SQUARE,
+		SUB_SAW,
+		SUB_SHAPES_LEN
+	};
+
+	enum SubOctave {
+		SUB_TWO_DOWN,
+		SUB_ONE_DOWN,
+		SUB_ONE_UP,
+		SUB_OCTAVES_LEN
+	};
+
+	//quality of the 96khz to engine rate converters, a cpu tradeoff. draft for live sets, high for offline renders
+	enum SrcQuality {
+		SRC_DRAFT,
+		SRC_NORMAL,
+		SRC_HIGH,
+		SRC_QUALITIES_LEN
+	};
+
+	const int srcQualityLevels[SRC_QUALITIES_LEN] = {2, 4, 8}; //speex resampler quality, 4 is the library default
+
+	//lfo mode has its own engine, a plain phase accumulator per voice with the shapes worked out from the phase.
+	//the noise outputs become random lfos, new values every cycle
+	struct LfoCore {
+		float_4 phase = 0.f;
+		float_4 cycles = 0.f;
+		float_4 randomFrom = 0.f; //pitched noise glides from the last value to the next over one cycle
+		float_4 randomTo = 0.f; //digital noise holds the next value for one cycle
+	};
+
+	LfoCore lfoCores[MAX_VOICES / 4];
+
+	//the noise output is generated straight at the engine rate. one xorshift generator per voice, pink and brown are
+	//filtered from the white noise
+	enum NoiseColor {
+		WHITE_NOISE,
+		PINK_NOISE,
+		BROWN_NOISE,
+		NOISE_COLORS_LEN
+	};
+
+	struct NoiseCore {
+		uint32_t state[4] = {1, 1, 1, 1};
+		uint32_t dither[4] = {1, 1, 1, 1}; //separate generator for the bit reduction dither
+		float_4 pink[7] = {}; //paul kellet's filter bank
+		float_4 brown = 0.f;
+	};
+
+	NoiseCore noiseCores[MAX_VOICES / 4];
+
+	enum BitCrushMode {
+		CRUSH_PLAIN,
+		CRUSH_ADAA,
+		CRUSH_MODES_LEN
+	};
+
+	//what the index mod input and its knob modulate. the bit depth shares them, there is no room left for its own jack
+	enum IndexModTarget {
+		INDEXMOD_INDEX,
+		INDEXMOD_BITS,
+		INDEXMOD_INDEX_AND_BITS,
+		INDEXMOD_TARGETS_LEN
+	};
+
+	//hard sync, edge detected every sample. lanes with an edge in the current sample are set in syncEdges, and in
+	//clockEdges when the sync input also clocks the digital noise
+	dsp::TSchmittTrigger<float_4> syncTriggers[MAX_VOICES / 4];
+	float_4 syncEdges[MAX_VOICES / 4] = {};
+	float_4 syncFraction[MAX_VOICES / 4] = {}; //how far into the sample the edge crossed, 0 right on it
+	float_4 syncLast[MAX_VOICES / 4] = {}; //last sync voltage
+	float_4 clockEdges[MAX_VOICES / 4] = {};
+
+	enum SyncTarget {
+		SYNC_OSCILLATORS,
+		SYNC_NOISE_CLOCK,
+		SYNC_OSCILLATORS_AND_NOISE_CLOCK,
+		SYNC_TARGETS_LEN
+	};
+
+	//digital noise on an external clock is a sample and hold per voice, no braids render. the values repeat after the
+	//cycle length in steps, until the knob is all the way up and they never do
+	struct ClockedNoiseCore {
+		uint32_t state[4] = {1, 1, 1, 1};
+		uint32_t pattern[4] = {1, 1, 1, 1}; //state the repeating pattern starts from
+		int step[4] = {};
+		float_4 value = 0.f;
+	};
+
+	ClockedNoiseCore clockedNoiseCores[MAX_VOICES / 4];
+	bool externalNoiseClock = false; //the sync input is patched and clocks the noise
+
+	const float LFO_BASE_FREQ = dsp::FREQ_C4 / 100.f; //0V, about 2.6Hz
+	const float LFO_MIN_PITCH = -10.f; //about 6.5 minutes per cycle
+	const float LFO_MAX_PITCH = 5.f;
 
-	//triangle signal generation
-	braids::MacroOscillator triOsc;
-	dsp::SampleRateConverter<1> triSRC;
-	dsp::DoubleRingBuffer<dsp::Frame<1>, 256> triOutputBuffer;
-	
-	//sawtooth signal generation
-	braids::MacroOscillator sawOsc;
-	dsp::SampleRateConverter<1> sawSRC;
-	dsp::DoubleRingBuffer<dsp::Frame<1>, 256> sawOutputBuffer;
-
-	//pulse signal generation
-	braids::MacroOscillator pulseOsc;
-	dsp::SampleRateConverter<1> pulseSRC;
-	dsp::DoubleRingBuffer<dsp::Frame<1>, 256> pulseOutputBuffer;
-
-	//sine signal generation
-	braids::MacroOscillator sineOsc;
-	dsp::SampleRateConverter<1> sineSRC;
-	dsp::DoubleRingBuffer<dsp::Frame<1>, 256> sineOutputBuffer;
-
-	//subSQ signal generation
-	braids::MacroOscillator subSQOsc;
-	dsp::SampleRateConverter<1> subSQSRC;
-	dsp::DoubleRingBuffer<dsp::Frame<1>, 256> subSQOutputBuffer;
-
-	//WLIN signal generation
-	braids::MacroOscillator WLINOsc;
-	dsp::SampleRateConverter<1> WLINSRC;
-	dsp::DoubleRingBuffer<dsp::Frame<1>, 256> WLINOutputBuffer;
-
-	//Noise signal generation
-	braids::MacroOscillator NoiseOsc;
-	dsp::SampleRateConverter<1> NoiseSRC;
-	dsp::DoubleRingBuffer<dsp::Frame<1>, 256> NoiseOutputBuffer;
-	
-	//pitchedNoise signal generation
-	braids::MacroOscillator pitchedNoiseOsc;
-	dsp::SampleRateConverter<1> pitchedNoiseSRC;
-	dsp::DoubleRingBuffer<dsp::Frame<1>, 256> pitchedNoiseOutputBuffer;
-
-	//clockedNoise signal generation
-	braids::MacroOscillator clockedNoiseOsc;
-	dsp::SampleRateConverter<1> clockedNoiseSRC;
-	dsp::DoubleRingBuffer<dsp::Frame<1>, 256> clockedNoiseOutputBuffer;
-	
 	//SchmittTriggers for octave buttons
 	dsp::SchmittTrigger octUpButton;
 	dsp::SchmittTrigger octDownButton;
@@ -201,55 +490,38 @@ struct BaseOsc : Module {
 		configInput(FM_INPUT, "Frequency Modulation");
 		configInput(PWM_INPUT, "Pulse Width Modulation");
 		configInput(INDEXMOD_INPUT, "Index Modulation");
+		configInput(SYNC_INPUT, "Hard Sync");
 		configOutput(TRI_OUTPUT, "Triangle");
 		configOutput(SAW_OUTPUT, "Sawtooth");
 		configOutput(PULSE_OUTPUT, "Pulse");
 		configOutput(SINE_OUTPUT, "Sine");
-		configOutput(SUBSQUARE_OUTPUT, "Sub Square");
+		configOutput(SUBSQUARE_OUTPUT, "Sub");
 		configOutput(WAVETABLE_OUTPUT, "Wavetable Linear");
 		configOutput(NOISE_OUTPUT, "Noise");
 		configOutput(PITCHEDNOISE_OUTPUT, "Pitched Noise");
 		configOutput(CLOCKEDNOISE_OUTPUT, "Digital Noise");
+		configOutput(QUANTIZED_OUTPUT, "Quantized V/Oct");
 
-		//quantizer init
-		quantizer.Init();
-		
-		//tri output
-		std::memset(&triOsc, 0, sizeof(triOsc));
-		triOsc.Init();
-		
-		//saw output
-		std::memset(&sawOsc, 0, sizeof(sawOsc));
-		sawOsc.Init();
-
-		//pulse output
-		std::memset(&pulseOsc, 0, sizeof(pulseOsc));
-		pulseOsc.Init();
-
-		//sine output
-		std::memset(&sineOsc, 0, sizeof(sineOsc));
-		sineOsc.Init();
+		std::fill(quantizerCodewords, quantizerCodewords + MAX_VOICES, -1);
 
-		//subSQ output
-		std::memset(&subSQOsc, 0, sizeof(subSQOsc));
-		subSQOsc.Init();
+		//every instance gets its own noise, unless a fixed seed is loaded with the patch
+		noiseSeed = random::u32();
+		seedNoise();
 
-		//WLIN output
-		std::memset(&WLINOsc, 0, sizeof(WLINOsc));
-		WLINOsc.Init();
-
-		//Noise output
-		std::memset(&NoiseOsc, 0, sizeof(NoiseOsc));
-		NoiseOsc.Init();
-
-		//pitchedNoise output
-		std::memset(&pitchedNoiseOsc, 0, sizeof(pitchedNoiseOsc));
-		pitchedNoiseOsc.Init();
+		rebuildEngines();
+		EngineWorker::get().add(this, [this]() {rebuildEngines();});
+	}
 
-		//clockedNoise output
-		std::memset(&clockedNoiseOsc, 0, sizeof(clockedNoiseOsc));
-		clockedNoiseOsc.Init();
+	~BaseOsc() {
+		EngineWorker::get().remove(this);
+		if (wavetableLoader.joinable()) {
+			wavetableLoader.join();
+		}
 
+		//everything goes back to the pools for the next module
+		while (!rigs.empty()) {
+			freeRig(rigs.back());
+		}
 	}
 
 	// Create an array of lights based on ENUMS
@@ -268,19 +540,14 @@ const int keyLights[12] = {
     QNTLEDB_LIGHT        // B
 };
 
-void updateLights(int quantizedNote, const braids::Scale& scale, int root) {
-   
-    // Determine which notes are active in the scale
-    bool active_notes[12] = { false }; // 12 notes: C, C#, D, D#, E, F, F#, G, G#, A, A#, B
+void updateLights(int quantizedNote) {
 
-     // Calculate the root index (ensure it is within the range of 0 to 11)
-    int rootIndex = root % 12;
-
-	// Set the active notes based on the scale
-    for (size_t i = 0; i < scale.num_notes; ++i) {
-        int note = ((scale.notes[i] / 128) + rootIndex) % 12; // Adjust for root
-        active_notes[note] = true; // Mark this note as active
-    }
+	// notes of the current scale come from the quantizer table. scala tables are not transposed, turn them to the root here
+	bool active_notes[12];
+	int rootIndex = scalaTuning ? (quantizerRoot / 128) % 12 : 0;
+	for (int i = 0; i < 12; i++) {
+		active_notes[(i + rootIndex) % 12] = getQuantizerTable().activeNotes[i];
+	}
 
 	// Array for black key positions
     const int blackKeys[] = { 1, 3, 6, 8, 10 }; // MIDI numbers for C#, D#, F#, G#, A#
@@ -289,7 +556,7 @@ void updateLights(int quantizedNote, const braids::Scale& scale, int root) {
         if (active_notes[i]) {
             bool isBlackKey = false;
             // Check if the note is a black key
-            for (int j = 0; j < sizeof(blackKeys) / sizeof(blackKeys[0]); ++j) {
+            for (size_t j = 0; j < sizeof(blackKeys) / sizeof(blackKeys[0]); ++j) {
                 if (i == blackKeys[j]) {
                     isBlackKey = true;
                     break;
@@ -325,55 +592,114 @@ void updateLights(int quantizedNote, const braids::Scale& scale, int root) {
 	bool isLFOmode = false;
 	bool isLINfm = true;
 	int octOffsetButtons = 0; //range of -5 to +5
-
-	//pitch from CV inputs
-	float sumPitchCV = 0.f; //calculated based on pitch inputs
-	int32_t pitchBraids = 0;
+	int analogCore = NATIVE_CORE; //new modules get the native core, patches saved before it existed keep braids
+	int srcQuality = SRC_NORMAL;
+	int subShape = SUB_SQUARE;
+	int subOctave = SUB_TWO_DOWN;
+	int noiseColor = WHITE_NOISE;
+	bool fixedNoiseSeed = false; //same noise every time the patch loads, for renders that have to come out the same
+	uint32_t noiseSeed = 0;
+	bool noiseReseed = false; //set from the menu, the audio thread reseeds at control rate
+	int bitCrushMode = CRUSH_ADAA; //patches saved before it existed keep the plain crush
+	bool bitDither = false;
+	int indexModTarget = INDEXMOD_INDEX;
+	int syncTarget = SYNC_OSCILLATORS;
+	bool quantizerOnly = false; //only the quantized output runs, every oscillator is off
+
+	//pitch from CV inputs, per voice
+	float basePitchCV[MAX_VOICES] = {}; //quantized, before fm. glides to the block target by basePitchStep every sample
+	float blockPitchCV[MAX_VOICES] = {}; //getPitchCV from the control sample, the quantized output reuses it there
+	float basePitchStep[MAX_VOICES] = {};
+	float sumPitchCV[MAX_VOICES] = {}; //calculated based on pitch inputs
+	float pitchOffset = 0.f; //coarse, fine and the octave buttons
+	float fmAmount = 0.f;
+	float fmSignal[MAX_VOICES] = {}; //attenuverted fm input of the current sample
+	int32_t pitchBraids[MAX_VOICES] = {};
+	int32_t quantizedPitchBraids = 0; //first voice, before FM. drives the quantizer LEDs
 	float lastPitchLEDcv = 0.1f; //only check pitch LEDs when there is a new pitch cv
-	float lfoModeSkipCounter = 0.f;
-	float lfoModeSkipThreshold = 0.f; //use this to keep LFO consistent over different sample rates
 	bool lastLFOmode = true;
 
 	//quantizer variables
 	int quantizerScale = 0;
 	int quantizerRoot = 0;
-
-	//pw variables
-	float basedPulseWidth = 0.f; //center point
-	float pulseWidth = 0.f;
-
-	float basedClockedNoiseCycleLength = 0.f;
-	float clockedNoiseCycleLength = 0.f;
-
-	//index variables
-	float basedIndex = 0.f; //this is the center point / starting index before modulation
-	float wavetableIndex = 0.f;
-	
-	float basedClockedQuantBits = 0.f;
-	float clockedQuantBits = 0.f;
+	int lastQuantizerScale = -1; //rebuild the table when scale or root changes
+	int lastQuantizerRoot = -1;
+	QuantizerTable quantizerTable;
+	int quantizerCodewords[MAX_VOICES]; //current note of each voice in the table
+
+	//scala tuning, replaces the braids scales while the quantizer is on. loaded on the calling thread and handed over
+	//through pendingScala like the wavetables
+	std::string scalaPath; //empty for the braids scales
+	std::string kbmPath; //empty for the default keyboard mapping
+	std::shared_ptr<const ScalaTuning> scalaTuning;
+	std::shared_ptr<const ScalaTuning> pendingScala;
+	std::atomic<bool> scalaPending{false};
+	std::atomic<bool> scalaLoaded{false}; //for the menu, which must not touch scalaTuning while the audio thread swaps it
+	std::mutex scalaMutex;
+	const ScalaTuning* lastScalaTuning = NULL;
+
+	//pw variables, per voice
+	float pulseWidth[MAX_VOICES] = {};
+	float pulseWidthStep[MAX_VOICES] = {};
+	float clockedNoiseCycleLength[MAX_VOICES] = {};
+
+	//index variables, per voice
+	float wavetableIndex[MAX_VOICES] = {};
+	float clockedQuantBits[MAX_VOICES] = {};
 
 	//oscillator lights, either pitch for regular mode or cv out for lfo mode
 	float posNegLEDvalue = 0.f;
 	float numConnected = 0.001f;
 
-	//bit setting
-	int outputBits = 16;
-	int16_t bitMask = 0;
+	//bit reduction, per voice since the bits can be modulated. lanes at 16 bits are passed through untouched
+	float_4 crushStep[MAX_VOICES / 4] = {};
+	float_4 crushBypass[MAX_VOICES / 4] = {};
+	float_4 crushLast[OUTPUTS_LEN][MAX_VOICES / 4] = {}; //last input of every output, for the antialiased crush
+	uint32_t outputsWritten[OUTPUTS_LEN] = {}; //channels written this sample, the crush leaves the others alone
+	bool bitCrushActive = false;
+
+	//wavetable loaded from a wav file, replaces the braids tables on the wavetable output. the loader thread leaves it
+	//in loadedWavetable and the next rig carries it to the audio thread, so the table and the engines without the
+	//braids wavetable arrive together. the rig also keeps it alive until the worker frees it
+	std::string wavetablePath; //empty for the braids tables
+	const UserWavetable* userWavetable = NULL; //audio thread, the table of the rig in use
+	std::shared_ptr<const UserWavetable> loadedWavetable;
+	std::atomic<bool> wavetableLoaded{false}; //for the menu, which must not touch the table
+	std::mutex wavetableMutex;
+	std::thread wavetableLoader;
+	float wavetableLevelOffset = 0.f; //mip level of 0V at the current sample rate, before rounding up
 
 
 	// save/load variables that aren't based on knobs etc.
 	json_t* dataToJson() override {
-		json_t* rootJ = json_object();
+		json_t* rootJ = ControlRateModule::dataToJson();
 		
 		// Save state variables
 		json_object_set_new(rootJ, "isLFOmode", json_boolean(isLFOmode));
 		json_object_set_new(rootJ, "isLINfm", json_boolean(isLINfm));
 		json_object_set_new(rootJ, "octOffsetButtons", json_integer(octOffsetButtons));
+		json_object_set_new(rootJ, "analogCore", json_integer(analogCore));
+		json_object_set_new(rootJ, "wavetablePath", json_string(wavetablePath.c_str()));
+		json_object_set_new(rootJ, "scalaPath", json_string(scalaPath.c_str()));
+		json_object_set_new(rootJ, "kbmPath", json_string(kbmPath.c_str()));
+		json_object_set_new(rootJ, "srcQuality", json_integer(srcQuality));
+		json_object_set_new(rootJ, "subShape", json_integer(subShape));
+		json_object_set_new(rootJ, "subOctave", json_integer(subOctave));
+		json_object_set_new(rootJ, "noiseColor", json_integer(noiseColor));
+		json_object_set_new(rootJ, "fixedNoiseSeed", json_boolean(fixedNoiseSeed));
+		json_object_set_new(rootJ, "noiseSeed", json_integer(noiseSeed));
+		json_object_set_new(rootJ, "bitCrushMode", json_integer(bitCrushMode));
+		json_object_set_new(rootJ, "bitDither", json_boolean(bitDither));
+		json_object_set_new(rootJ, "indexModTarget", json_integer(indexModTarget));
+		json_object_set_new(rootJ, "syncTarget", json_integer(syncTarget));
+		json_object_set_new(rootJ, "quantizerOnly", json_boolean(quantizerOnly));
 		
 		return rootJ;
 	}
 
 	void dataFromJson(json_t* rootJ) override {
+		ControlRateModule::dataFromJson(rootJ);
+
 		json_t* isLFOmodeJ = json_object_get(rootJ, "isLFOmode");
 		if (isLFOmodeJ)
 			isLFOmode = json_is_true(isLFOmodeJ);
@@ -385,773 +711,1155 @@ void updateLights(int quantizedNote, const braids::Scale& scale, int root) {
 		json_t* octOffsetButtonsJ = json_object_get(rootJ, "octOffsetButtons");
 		if (octOffsetButtonsJ)
 			octOffsetButtons = json_integer_value(octOffsetButtonsJ);
-	}
 
+		json_t* analogCoreJ = json_object_get(rootJ, "analogCore");
+		if (analogCoreJ)
+			analogCore = clamp((int) json_integer_value(analogCoreJ), 0, ANALOG_CORES_LEN - 1);
+		else
+			analogCore = BRAIDS_CORE; //older patches were made with the braids shapes, keep them sounding the same
 
-	//main process
-	void process(const ProcessArgs& args) override {
+		json_t* srcQualityJ = json_object_get(rootJ, "srcQuality");
+		if (srcQualityJ)
+			srcQuality = clamp((int) json_integer_value(srcQualityJ), 0, SRC_QUALITIES_LEN - 1);
 
-	//octave buttons
-	if(octUpButton.process(params[OCTUP_PARAM].getValue())){
-		if(octOffsetButtons < 5){
-			octOffsetButtons++;
+		json_t* subShapeJ = json_object_get(rootJ, "subShape");
+		if (subShapeJ)
+			subShape = clamp((int) json_integer_value(subShapeJ), 0, SUB_SHAPES_LEN - 1);
+
+		json_t* subOctaveJ = json_object_get(rootJ, "subOctave");
+		if (subOctaveJ)
+			subOctave = clamp((int) json_integer_value(subOctaveJ), 0, SUB_OCTAVES_LEN - 1);
+
+		json_t* noiseColorJ = json_object_get(rootJ, "noiseColor");
+		if (noiseColorJ)
+			noiseColor = clamp((int) json_integer_value(noiseColorJ), 0, NOISE_COLORS_LEN - 1);
+
+		json_t* fixedNoiseSeedJ = json_object_get(rootJ, "fixedNoiseSeed");
+		if (fixedNoiseSeedJ)
+			fixedNoiseSeed = json_is_true(fixedNoiseSeedJ);
+
+		json_t* noiseSeedJ = json_object_get(rootJ, "noiseSeed");
+		if (noiseSeedJ && fixedNoiseSeed) {
+			noiseSeed = json_integer_value(noiseSeedJ);
+			seedNoise();
 		}
+
+		json_t* bitCrushModeJ = json_object_get(rootJ, "bitCrushMode");
+		if (bitCrushModeJ)
+			bitCrushMode = clamp((int) json_integer_value(bitCrushModeJ), 0, CRUSH_MODES_LEN - 1);
+		else
+			bitCrushMode = CRUSH_PLAIN;
+
+		json_t* bitDitherJ = json_object_get(rootJ, "bitDither");
+		if (bitDitherJ)
+			bitDither = json_is_true(bitDitherJ);
+
+		json_t* indexModTargetJ = json_object_get(rootJ, "indexModTarget");
+		if (indexModTargetJ)
+			indexModTarget = clamp((int) json_integer_value(indexModTargetJ), 0, INDEXMOD_TARGETS_LEN - 1);
+
+		json_t* syncTargetJ = json_object_get(rootJ, "syncTarget");
+		if (syncTargetJ)
+			syncTarget = clamp((int) json_integer_value(syncTargetJ), 0, SYNC_TARGETS_LEN - 1);
+
+		json_t* quantizerOnlyJ = json_object_get(rootJ, "quantizerOnly");
+		if (quantizerOnlyJ)
+			quantizerOnly = json_is_true(quantizerOnlyJ);
+
+		json_t* scalaPathJ = json_object_get(rootJ, "scalaPath");
+		json_t* kbmPathJ = json_object_get(rootJ, "kbmPath");
+		std::string sclPath = scalaPathJ ? json_string_value(scalaPathJ) : "";
+		std::string mappingPath = kbmPathJ ? json_string_value(kbmPathJ) : "";
+		if (sclPath != scalaPath || mappingPath != kbmPath)
+			loadScala(sclPath, mappingPath);
+
+		json_t* wavetablePathJ = json_object_get(rootJ, "wavetablePath");
+		std::string path = wavetablePathJ ? json_string_value(wavetablePathJ) : "";
+		if (path != wavetablePath)
+			loadWavetable(path);
+
+		rebuildEngines();
 	}
 
-	if(octDownButton.process(params[OCTDOWN_PARAM].getValue())){
-		if(octOffsetButtons > -5){
-			octOffsetButtons--;
+	//builds the table on a background thread, an empty path goes back to the braids tables. a file that can't be
+	//loaded also leaves the braids tables playing, but the path is kept so the patch still points at it
+	void loadWavetable(const std::string& path) {
+		if (wavetableLoader.joinable()) {
+			wavetableLoader.join();
 		}
-	}
+		wavetablePath = path;
+
+		wavetableLoader = std::thread([this, path]() {
+			std::shared_ptr<const UserWavetable> table;
+			if (!path.empty()) {
+				std::string error;
+				table = loadUserWavetable(path, error);
+				if (!table)
+					WARN("baseOsc could not load wavetable %s: %s", path.c_str(), error.c_str());
+			}
 
-	//toggle FM Mode
-	if(fmModeButton.process(params[FMLINEXPTOGGLE_PARAM].getValue())){
-		isLINfm = !isLINfm; //shorthand for inverting bool values in c++
-	}
-	
-	//toggle LFO Mode
-	if(lfoModeButton.process(params[LFOMODETOGGLE_PARAM].getValue())){
-		isLFOmode = !isLFOmode;
+			{
+				std::lock_guard<std::mutex> lock(wavetableMutex);
+				loadedWavetable = table;
+				wavetableLoaded = (bool) table;
+			}
+
+			//a loaded table replaces the braids engine on the wavetable output, the next rig brings both
+			rebuildEngines();
+		});
 	}
-	
 
-	//calculate pitch cv, allowing for quantization before FM modulation
-	quantizerScale = params[QNTSCALE_PARAM].getValue();
-	quantizerRoot = (params[QNTROOT_PARAM].getValue()+60)*128;
 
-	sumPitchCV = (inputs[VOCT_INPUT].getVoltage()+params[COARSETUNE_PARAM].getValue() + octOffsetButtons + (params[FINETUNE_PARAM].getValue()/12)); //before fm mod applied
+	//scala files are small, they are read right here. an empty scale path goes back to the braids scales. like the
+	//wavetables, the paths are kept when the files can't be loaded
+	void loadScala(const std::string& sclPath, const std::string& mappingPath) {
+		scalaPath = sclPath;
+		kbmPath = mappingPath;
 
-	sumPitchCV = clamp(sumPitchCV,-5.f,5.f);
-	
-	if(quantizerScale != 0){
+		std::shared_ptr<const ScalaTuning> tuning;
+		if (!sclPath.empty()) {
+			std::string error;
+			tuning = loadScalaTuning(sclPath, mappingPath, error);
+			if (!tuning)
+				WARN("baseOsc could not load tuning %s %s: %s", sclPath.c_str(), mappingPath.c_str(), error.c_str());
+		}
 
-		quantizer.Configure(braids::scales[quantizerScale]);
+		std::lock_guard<std::mutex> lock(scalaMutex);
+		pendingScala = tuning;
+		scalaPending = true;
+		scalaLoaded = (bool) tuning;
+	}
 
-		pitchBraids = (sumPitchCV * 12.0 + 60) * 128;
-		
-		pitchBraids = quantizer.Process(pitchBraids, quantizerRoot); //quantizer takes these values not the cv range.
+	const QuantizerTable& getQuantizerTable() {
+		return scalaTuning ? scalaTuning->table : quantizerTable;
+	}
 
-		sumPitchCV = ((pitchBraids / 128.0f) - 60.0f) / 12.0f; //get back to cv so fm mod can be applied
+	//v/oct plus the tuning offsets for the voices c to c+3, quantized when a scale is on. this is the pitch before fm
+	float_4 getPitchCV(int c) {
+		float_4 pitchCV = inputs[VOCT_INPUT].getPolyVoltageSimd<float_4>(c) + pitchOffset;
 
-		// Determine the quantized note based on the processed pitch
-		int quantizedNote = static_cast<int>(pitchBraids / 128.0f) % 12; // Get the note number in the range 0-11
-		int quantizedRootLED = static_cast<int>(quantizerRoot / 128.0f) % 12; // Get the note number in the range 0-11
-		const braids::Scale& currentScale = braids::scales[quantizerScale];
+		pitchCV = simd::clamp(pitchCV, isLFOmode ? LFO_MIN_PITCH : -5.f, 5.f);
 
-		// Update the lights based on the current scale and root
-		updateLights(quantizedNote,currentScale, quantizedRootLED);
-	}else{
-		 // all lights are off when the quantizer is off
-		for (int i = 0; i < 12; ++i) {
-			lights[keyLights[i]+0].setBrightness(0.0f); // off
-			lights[keyLights[i]+1].setBrightness(0.0f); 
-			lights[keyLights[i]+2].setBrightness(0.0f); 
-		}
-	}
+		if(quantizerScale != 0){
 
-	//add FM modulation based on active mode
-	if(isLINfm){ 
-		sumPitchCV = sumPitchCV+(params[FMAMT_PARAM].getValue()*inputs[FM_INPUT].getVoltage());
-	}else{
-		sumPitchCV = sumPitchCV+(std::pow(2.0f, params[FMAMT_PARAM].getValue() * inputs[FM_INPUT].getVoltage()) - 1.0f);
-	}	
-	
-	pitchBraids = (sumPitchCV * 12.0 + 60) * 128;
+			const QuantizerTable& table = getQuantizerTable();
+			int32_t tableShift = scalaTuning ? quantizerRoot - 60 * 128 : 0; //the root knob transposes scala tunings, C leaves them as they are
 
-	pitchBraids = clamp(pitchBraids, 0, 16383);	
+			//table lookup per voice, each voice keeps its own hysteresis state
+			for (int i = 0; i < 4 && c + i < channels; i++) {
 
-	//pitch led light logic. very clunky, look into optimizing this
-	if(lastPitchLEDcv != sumPitchCV || isLFOmode || isLFOmode != lastLFOmode){ 
-		
-		if(isLFOmode){
+				int32_t quantizedPitch = (pitchCV[i] * 12.0 + 60) * 128;
 
-			numConnected = 0.001f;
-			if(outputs[TRI_OUTPUT].isConnected()){
-				numConnected++;
-			}
-			if(outputs[SAW_OUTPUT].isConnected()){
-				numConnected++;
-			}
-			if(outputs[PULSE_OUTPUT].isConnected()){
-				numConnected++;
-			}
-			if(outputs[SINE_OUTPUT].isConnected()){
-				numConnected++;
-			}
-			if(outputs[SUBSQUARE_OUTPUT].isConnected()){
-				numConnected++;
-			}
-			if(outputs[WAVETABLE_OUTPUT].isConnected()){
-				numConnected++;
-			}
+				quantizedPitch = table.process(quantizedPitch - tableShift, quantizerCodewords[c + i]) + tableShift; //quantizer takes these values not the cv range.
 
-			numConnected = clamp(numConnected, 0.001f, 10.f); //lookout for divide by zero errors!
-			
-			if(numConnected > 0.001 && numConnected < 1.9){
-			posNegLEDvalue = ((outputs[TRI_OUTPUT].getVoltage()+outputs[SAW_OUTPUT].getVoltage()+outputs[PULSE_OUTPUT].getVoltage()+outputs[SINE_OUTPUT].getVoltage()+outputs[SUBSQUARE_OUTPUT].getVoltage()+outputs[WAVETABLE_OUTPUT].getVoltage())/(numConnected+.001f))*1.1;
-			}else{
-				if(outputs[SINE_OUTPUT].isConnected()){
-					posNegLEDvalue = outputs[SINE_OUTPUT].getVoltage()*1.1;	
-				}else if(outputs[TRI_OUTPUT].isConnected()){
-					posNegLEDvalue = outputs[TRI_OUTPUT].getVoltage()*1.1;
-				}else if(outputs[SAW_OUTPUT].isConnected()){
-					posNegLEDvalue = outputs[SAW_OUTPUT].getVoltage()*1.1;
-				}else if(outputs[PULSE_OUTPUT].isConnected()){
-					posNegLEDvalue = outputs[PULSE_OUTPUT].getVoltage()*1.1;
-				}else if(outputs[SUBSQUARE_OUTPUT].isConnected()){
-					posNegLEDvalue = outputs[SUBSQUARE_OUTPUT].getVoltage()*1.1;
-				}else if(outputs[WAVETABLE_OUTPUT].isConnected()){
-					posNegLEDvalue = outputs[WAVETABLE_OUTPUT].getVoltage()*1.1;
-				}else{
-					posNegLEDvalue = 0;
+				pitchCV[i] = ((quantizedPitch / 128.0f) - 60.0f) / 12.0f; //get back to cv so fm mod can be applied
+
+				if (c + i == 0) {
+					quantizedPitchBraids = quantizedPitch;
 				}
 			}
-
-			lastLFOmode = isLFOmode;
-		}else{
-			posNegLEDvalue = sumPitchCV;
-		}
-
-		if(posNegLEDvalue <= -5){
-		lights[N5LED_LIGHT].setBrightness(1.0f);
-		lights[N4LED_LIGHT].setBrightness(1.0f);
-		lights[N3LED_LIGHT].setBrightness(1.0f);
-		lights[N2LED_LIGHT].setBrightness(1.0f);
-		lights[N1LED_LIGHT].setBrightness(1.0f);
-		lights[ZEROLED_LIGHT].setBrightness(0.0f);
-		lights[P1LED_LIGHT].setBrightness(0.0f);
-		lights[P2LED_LIGHT].setBrightness(0.0f);
-		lights[P3LED_LIGHT].setBrightness(0.0f);
-		lights[P4LED_LIGHT].setBrightness(0.0f);
-		lights[P5LED_LIGHT].setBrightness(0.0f);
-		}
-		if(posNegLEDvalue > -5 && posNegLEDvalue <= -4){
-		lights[N5LED_LIGHT].setBrightness(0.0f);
-		lights[N4LED_LIGHT].setBrightness(1.0f);
-		lights[N3LED_LIGHT].setBrightness(1.0f);
-		lights[N2LED_LIGHT].setBrightness(1.0f);
-		lights[N1LED_LIGHT].setBrightness(1.0f);
-		lights[ZEROLED_LIGHT].setBrightness(0.0f);
-		lights[P1LED_LIGHT].setBrightness(0.0f);
-		lights[P2LED_LIGHT].setBrightness(0.0f);
-		lights[P3LED_LIGHT].setBrightness(0.0f);
-		lights[P4LED_LIGHT].setBrightness(0.0f);
-		lights[P5LED_LIGHT].setBrightness(0.0f);
-		}
-		if(posNegLEDvalue > -4 && posNegLEDvalue <= -3){
-		lights[N5LED_LIGHT].setBrightness(0.0f);
-		lights[N4LED_LIGHT].setBrightness(0.0f);
-		lights[N3LED_LIGHT].setBrightness(1.0f);
-		lights[N2LED_LIGHT].setBrightness(1.0f);
-		lights[N1LED_LIGHT].setBrightness(1.0f);
-		lights[ZEROLED_LIGHT].setBrightness(0.0f);
-		lights[P1LED_LIGHT].setBrightness(0.0f);
-		lights[P2LED_LIGHT].setBrightness(0.0f);
-		lights[P3LED_LIGHT].setBrightness(0.0f);
-		lights[P4LED_LIGHT].setBrightness(0.0f);
-		lights[P5LED_LIGHT].setBrightness(0.0f);
-		}
-		if(posNegLEDvalue > -3 && posNegLEDvalue <= -2){
-		lights[N5LED_LIGHT].setBrightness(0.0f);
-		lights[N4LED_LIGHT].setBrightness(0.0f);
-		lights[N3LED_LIGHT].setBrightness(0.0f);
-		lights[N2LED_LIGHT].setBrightness(1.0f);
-		lights[N1LED_LIGHT].setBrightness(1.0f);
-		lights[ZEROLED_LIGHT].setBrightness(0.0f);
-		lights[P1LED_LIGHT].setBrightness(0.0f);
-		lights[P2LED_LIGHT].setBrightness(0.0f);
-		lights[P3LED_LIGHT].setBrightness(0.0f);
-		lights[P4LED_LIGHT].setBrightness(0.0f);
-		lights[P5LED_LIGHT].setBrightness(0.0f);
-		}
-		if(posNegLEDvalue > -2 && posNegLEDvalue <= -1){
-		lights[N5LED_LIGHT].setBrightness(0.0f);
-		lights[N4LED_LIGHT].setBrightness(0.0f);
-		lights[N3LED_LIGHT].setBrightness(0.0f);
-		lights[N2LED_LIGHT].setBrightness(0.0f);
-		lights[N1LED_LIGHT].setBrightness(1.0f);
-		lights[ZEROLED_LIGHT].setBrightness(0.0f);
-		lights[P1LED_LIGHT].setBrightness(0.0f);
-		lights[P2LED_LIGHT].setBrightness(0.0f);
-		lights[P3LED_LIGHT].setBrightness(0.0f);
-		lights[P4LED_LIGHT].setBrightness(0.0f);
-		lights[P5LED_LIGHT].setBrightness(0.0f);
-		}
-		if(posNegLEDvalue > -1 && posNegLEDvalue < 1){
-		lights[N5LED_LIGHT].setBrightness(0.0f);
-		lights[N4LED_LIGHT].setBrightness(0.0f);
-		lights[N3LED_LIGHT].setBrightness(0.0f);
-		lights[N2LED_LIGHT].setBrightness(0.0f);
-		lights[N1LED_LIGHT].setBrightness(0.0f);
-		lights[ZEROLED_LIGHT].setBrightness(1.0f);
-		lights[P1LED_LIGHT].setBrightness(0.0f);
-		lights[P2LED_LIGHT].setBrightness(0.0f);
-		lights[P3LED_LIGHT].setBrightness(0.0f);
-		lights[P4LED_LIGHT].setBrightness(0.0f);
-		lights[P5LED_LIGHT].setBrightness(0.0f);
-		}
-		if(posNegLEDvalue >= 1 && posNegLEDvalue < 2){
-		lights[N5LED_LIGHT].setBrightness(0.0f);
-		lights[N4LED_LIGHT].setBrightness(0.0f);
-		lights[N3LED_LIGHT].setBrightness(0.0f);
-		lights[N2LED_LIGHT].setBrightness(0.0f);
-		lights[N1LED_LIGHT].setBrightness(0.0f);
-		lights[ZEROLED_LIGHT].setBrightness(0.0f);
-		lights[P1LED_LIGHT].setBrightness(1.0f);
-		lights[P2LED_LIGHT].setBrightness(0.0f);
-		lights[P3LED_LIGHT].setBrightness(0.0f);
-		lights[P4LED_LIGHT].setBrightness(0.0f);
-		lights[P5LED_LIGHT].setBrightness(0.0f);
-		}
-		if(posNegLEDvalue >= 2 && posNegLEDvalue < 3){
-		lights[N5LED_LIGHT].setBrightness(0.0f);
-		lights[N4LED_LIGHT].setBrightness(0.0f);
-		lights[N3LED_LIGHT].setBrightness(0.0f);
-		lights[N2LED_LIGHT].setBrightness(0.0f);
-		lights[N1LED_LIGHT].setBrightness(0.0f);
-		lights[ZEROLED_LIGHT].setBrightness(0.0f);
-		lights[P1LED_LIGHT].setBrightness(1.0f);
-		lights[P2LED_LIGHT].setBrightness(1.0f);
-		lights[P3LED_LIGHT].setBrightness(0.0f);
-		lights[P4LED_LIGHT].setBrightness(0.0f);
-		lights[P5LED_LIGHT].setBrightness(0.0f);
-		}
-		if(posNegLEDvalue >= 3 && posNegLEDvalue < 4){
-		lights[N5LED_LIGHT].setBrightness(0.0f);
-		lights[N4LED_LIGHT].setBrightness(0.0f);
-		lights[N3LED_LIGHT].setBrightness(0.0f);
-		lights[N2LED_LIGHT].setBrightness(0.0f);
-		lights[N1LED_LIGHT].setBrightness(0.0f);
-		lights[ZEROLED_LIGHT].setBrightness(0.0f);
-		lights[P1LED_LIGHT].setBrightness(1.0f);
-		lights[P2LED_LIGHT].setBrightness(1.0f);
-		lights[P3LED_LIGHT].setBrightness(1.0f);
-		lights[P4LED_LIGHT].setBrightness(0.0f);
-		lights[P5LED_LIGHT].setBrightness(0.0f);
-		}
-		if(posNegLEDvalue >= 4 && posNegLEDvalue < 5){
-		lights[N5LED_LIGHT].setBrightness(0.0f);
-		lights[N4LED_LIGHT].setBrightness(0.0f);
-		lights[N3LED_LIGHT].setBrightness(0.0f);
-		lights[N2LED_LIGHT].setBrightness(0.0f);
-		lights[N1LED_LIGHT].setBrightness(0.0f);
-		lights[ZEROLED_LIGHT].setBrightness(0.0f);
-		lights[P1LED_LIGHT].setBrightness(1.0f);
-		lights[P2LED_LIGHT].setBrightness(1.0f);
-		lights[P3LED_LIGHT].setBrightness(1.0f);
-		lights[P4LED_LIGHT].setBrightness(1.0f);
-		lights[P5LED_LIGHT].setBrightness(0.0f);
-		}
-		if(posNegLEDvalue >= 5){
-		lights[N5LED_LIGHT].setBrightness(0.0f);
-		lights[N4LED_LIGHT].setBrightness(0.0f);
-		lights[N3LED_LIGHT].setBrightness(0.0f);
-		lights[N2LED_LIGHT].setBrightness(0.0f);
-		lights[N1LED_LIGHT].setBrightness(0.0f);
-		lights[ZEROLED_LIGHT].setBrightness(0.0f);
-		lights[P1LED_LIGHT].setBrightness(1.0f);
-		lights[P2LED_LIGHT].setBrightness(1.0f);
-		lights[P3LED_LIGHT].setBrightness(1.0f);
-		lights[P4LED_LIGHT].setBrightness(1.0f);
-		lights[P5LED_LIGHT].setBrightness(1.0f);
 		}
 
-	} //end of LED statements
+		return pitchCV;
+	}
+
 
+	//keeps modulated index style values inside 0-32767 by bouncing them off the edges, so negative modulation stays smooth
+	static float_4 reflectIndex(float_4 value) {
+		value = simd::fmod(value, 65534.f); // 65534 = 2 * 32767
+		value = simd::ifelse(value < 0.f, -value, value); // reflect negative values
+		value = simd::ifelse(value > 32767.f, 65534.f - value, value); // reflect back into the range
+		return simd::clamp(value, 0.f, 32767.f);
+	}
 
-	lastPitchLEDcv = sumPitchCV; //this goes after the LEDs are processed. if they are equal the next process, the led logic will not be looked at.
+	//renders the next 96khz block of one engine of voice c and converts it down to the engine rate
+	void renderEngine(int c, int e, Engine& engine) {
 
-	//get the pulse width value
+		int16_t param1[ENGINES_LEN] = {};
+		int16_t param2[ENGINES_LEN] = {};
 
-	basedPulseWidth = 32000 * (std::abs(params[PULSEWIDTH_PARAM].getValue()));
+		param2[TRI_ENGINE] = 0; //param1 for the oscillator mix. param2 is lp so 0 is full open
+		param1[SAW_ENGINE] = 10923;
+		param1[PULSE_ENGINE] = pulseWidth[c]; //param1 for the phase. param2 is for the osc shape
+		param2[PULSE_ENGINE] = 32767;
+		param1[WAVETABLE_ENGINE] = wavetableIndex[c]; //param 1 gives the index location, param 2 defines the interpolation method. 24575 gives a clean blend/interpolation of waves and samples.
+		param2[WAVETABLE_ENGINE] = 24575;
+		param1[PITCHEDNOISE_ENGINE] = 16385; //param1 for the resonance. param2 is for the filter mode
+		param2[PITCHEDNOISE_ENGINE] = 16385;
+		param1[CLOCKEDNOISE_ENGINE] = clockedNoiseCycleLength[c]; //param1 for the cycle length. param2 is for the quantized bits
+		param2[CLOCKEDNOISE_ENGINE] = clockedQuantBits[c];
+		param1[SUB_ENGINE] = 0; //the square end of saw-square, as the sub always was with the braids shapes
+		param2[SUB_ENGINE] = 32767;
 
-	if(inputs[PWM_INPUT].getVoltage() == 0 || !inputs[PWM_INPUT].isConnected() || params[PWMAMT_PARAM].getValue() == 0){
-		pulseWidth = basedPulseWidth;
-	} else{
-		pulseWidth = basedPulseWidth + ((std::abs(inputs[PWM_INPUT].getVoltage() / 5.0f)) * params[PWMAMT_PARAM].getValue() * 32000);
-	}
+		int16_t render_buffer[24];
 
-	pulseWidth = clamp(pulseWidth, 0.f, 32000.0f);
+		engine.osc.set_parameters(param1[e], param2[e]);
+		engine.osc.set_pitch(e == SUB_ENGINE ? pitchBraids[c] - 12 * 128 : pitchBraids[c]); //the braids sub is an octave down
+		engine.osc.Render(engine.syncBuffer, render_buffer, 24);
 
-	// Get the wavetable index value. this should allow smooth modulation with incoming negative voltage even when index is 0
+		std::memset(engine.syncBuffer, 0, sizeof(engine.syncBuffer));
+		engine.syncTime = 0.f;
 
-	basedIndex = 32767 * params[INDEX_PARAM].getValue();
+		//bit reduction happens after the converter, together with the other outputs
+		dsp::Frame<1> in[24];
+		for (int i = 0; i < 24; i++) {
+			in[i].samples[0] = render_buffer[i] / 32768.f;
+		}
 
-	if (inputs[INDEXMOD_INPUT].getVoltage() == 0 || !inputs[INDEXMOD_INPUT].isConnected() || params[INDEXMODAMT_PARAM].getValue() == 0) {
-		wavetableIndex = basedIndex;
-	} else {
-		
-		wavetableIndex = basedIndex + ((params[INDEXMODAMT_PARAM].getValue()/15.0f)*inputs[INDEXMOD_INPUT].getVoltage()*32767);
-		
+		// Sample rate convert
+		int inLen = 24;
+		int outLen = engine.outputBuffer.capacity();
+		engine.src.process(in, &inLen, engine.outputBuffer.endData(), &outLen);
+		engine.outputBuffer.endIncr(outLen);
 	}
 
-	// Ensure wavetableIndex is within bounds using modulo
-	wavetableIndex = fmod(wavetableIndex, 65534); // 65534 = 2 * 32767
-
-	// Handle negative values
-	if (wavetableIndex < 0) {
-		wavetableIndex = -wavetableIndex; // Reflect negative values
+	//spreads the seed over the generators of all voices, so no two voices run the same sequence
+	void seedNoise() {
+		for (int c = 0; c < MAX_VOICES; c++) {
+			uint32_t x = noiseSeed + 0x9E3779B9u * (c + 1);
+			x = (x ^ (x >> 16)) * 0x85EBCA6Bu;
+			x = (x ^ (x >> 13)) * 0xC2B2AE35u;
+			x ^= x >> 16;
+			noiseCores[c / 4].state[c % 4] = x ? x : 1; //xorshift gets stuck at 0
+			noiseCores[c / 4].dither[c % 4] = (x * 0x2C1B3C6Du) | 1;
+			clockedNoiseCores[c / 4].pattern[c % 4] = (x * 0x297A2D39u) | 1;
+			clockedNoiseCores[c / 4].state[c % 4] = clockedNoiseCores[c / 4].pattern[c % 4];
+			clockedNoiseCores[c / 4].step[c % 4] = 0;
+		}
+		for (int i = 0; i < MAX_VOICES / 4; i++) {
+			std::fill(noiseCores[i].pink, noiseCores[i].pink + 7, 0.f);
+			noiseCores[i].brown = 0.f;
+		}
 	}
 
-	// Apply final bouncing logic
-	if (wavetableIndex > 32767) {
-		wavetableIndex = 65534 - wavetableIndex; // Reflect back into the range
+	//xorshift32 on four lanes, uniform between -1 and 1. the loop vectorizes
+	static float_4 xorshift(uint32_t* state) {
+		int32_t bits[4];
+		for (int i = 0; i < 4; i++) {
+			uint32_t x = state[i];
+			x ^= x << 13;
+			x ^= x >> 17;
+			x ^= x << 5;
+			state[i] = x;
+			bits[i] = (int32_t) x;
+		}
+		return float_4(bits[0], bits[1], bits[2], bits[3]) * (1.f / 2147483648.f);
 	}
 
-	wavetableIndex = clamp(wavetableIndex, 0.f, 32767.0f);
+	//digital noise for the voices c to c+3, a new value on every clock edge. pulse width sets the cycle length like it
+	//does for braids, index the quantization: fully left is 16 bits, fully right 1 bit
+	void processClockedNoise(int c) {
 
+		ClockedNoiseCore& noise = clockedNoiseCores[c / 4];
+		int edges = simd::movemask(clockEdges[c / 4]);
 
-	//use pw and index inputs and controls to interact with the clocked noise settings. pw goes to cycle length, index goes to quantize bits amount
+		for (int i = 0; i < 4 && edges; i++) {
+			if (!(edges & (1 << i))) {
+				continue;
+			}
 
-	basedClockedNoiseCycleLength = 32767 * (std::abs(params[PULSEWIDTH_PARAM].getValue()));
+			int v = c + i;
+			int cycleSteps = 1 + (int) (clockedNoiseCycleLength[v] / 32767.f * 63.f);
+			bool endless = clockedNoiseCycleLength[v] > 32000.f;
+			if (!endless && noise.step[i] >= cycleSteps) {
+				noise.state[i] = noise.pattern[i];
+				noise.step[i] = 0;
+			}
+			noise.step[i]++;
+
+			uint32_t x = noise.state[i];
+			x ^= x << 13;
+			x ^= x >> 17;
+			x ^= x << 5;
+			noise.state[i] = x;
 
-	if (inputs[PWM_INPUT].getVoltage() == 0 || !inputs[PWM_INPUT].isConnected() || params[PWMAMT_PARAM].getValue() == 0) {
-		clockedNoiseCycleLength = basedClockedNoiseCycleLength;
-	} else {
-		clockedNoiseCycleLength = basedClockedNoiseCycleLength + ((params[PWMAMT_PARAM].getValue()/10.0f)*inputs[PWM_INPUT].getVoltage()*32767);
+			float levels = std::pow(2.f, 15.f - std::round(clockedQuantBits[v] / 32767.f * 15.f)); //per polarity
+			noise.value[i] = clamp(std::round((int32_t) x / 2147483648.f * levels) / levels, -1.f, 1.f);
+		}
+
+		writeOutput(CLOCKEDNOISE_OUTPUT, 5.f * noise.value, c);
 	}
 
-	clockedNoiseCycleLength = fmod(clockedNoiseCycleLength, 65534);
+	//one sample of noise for the voices c to c+3
+	void processNoise(int c) {
+
+		NoiseCore& noise = noiseCores[c / 4];
+
+		float_4 white = xorshift(noise.state);
+		float_4 out = white;
+
+		if (noiseColor == PINK_NOISE) {
+			float_4* b = noise.pink;
+			b[0] = 0.99886f * b[0] + white * 0.0555179f;
+			b[1] = 0.99332f * b[1] + white * 0.0750759f;
+			b[2] = 0.96900f * b[2] + white * 0.1538520f;
+			b[3] = 0.86650f * b[3] + white * 0.3104856f;
+			b[4] = 0.55000f * b[4] + white * 0.5329522f;
+			b[5] = -0.7616f * b[5] - white * 0.0168980f;
+			out = (b[0] + b[1] + b[2] + b[3] + b[4] + b[5] + b[6] + white * 0.5362f) * 0.15f;
+			b[6] = white * 0.115926f;
+		} else if (noiseColor == BROWN_NOISE) {
+			//the leaky integrator has an rms of 0.02 / sqrt(3 * (1.02^2 - 1)) = 0.0574 for uniform white noise. scaled to
+			//1/6 of full scale the clamp sits 6 sigma out and never touches it
+			noise.brown = (noise.brown + 0.02f * white) * (1.f / 1.02f);
+			out = noise.brown * 2.9f;
+		}
 
-	if (clockedNoiseCycleLength < 0) {
-		clockedNoiseCycleLength = -clockedNoiseCycleLength; 
+		writeOutput(NOISE_OUTPUT, 5.f * simd::clamp(out, -1.f, 1.f), c);
 	}
 
-	if (clockedNoiseCycleLength > 32767) {
-		clockedNoiseCycleLength = 65534 - clockedNoiseCycleLength; 
+	//2 point polyblep residual for a step of -2 at phase 0. t is the phase, dt the phase increment per sample
+	static float_4 polyBlep(float_4 t, float_4 dt) {
+		float_4 head = t / dt;
+		float_4 tail = (t - 1.f) / dt;
+		float_4 r = simd::ifelse(t < dt, head + head - head * head - 1.f, 0.f);
+		return simd::ifelse(t > 1.f - dt, tail * tail + tail + tail + 1.f, r);
 	}
 
-	clockedNoiseCycleLength = clamp(clockedNoiseCycleLength, 0.f, 32767.0f);
+	//2 point polyblamp residual for a corner at phase 0, scaled by the slope change per sample
+	static float_4 polyBlamp(float_4 t, float_4 dt) {
+		float_4 head = t / dt - 1.f;
+		float_4 tail = (t - 1.f) / dt + 1.f;
+		float_4 r = simd::ifelse(t < dt, head * head * head * (-1.f / 3.f), 0.f);
+		return simd::ifelse(t > 1.f - dt, tail * tail * tail * (1.f / 3.f), r);
+	}
 
-	basedClockedQuantBits = 32767 * params[INDEX_PARAM].getValue();
+	//polyblep for the jump of a hard sync reset, on the lanes in sync. frac is how far into the sample the edge crossed,
+	//before and after are the values on both sides of the jump. only the half after the edge can be applied, the sample
+	//before it is already out. the wrap residuals in value don't apply to a restarted phase, the naive shape replaces it
+	static float_4 syncStep(float_4 sync, float_4 frac, float_4 value, float_4 naive, float_4 before, float_4 after) {
+		return simd::ifelse(sync, naive + 0.5f * (before - after) * (1.f - frac) * (1.f - frac), value);
+	}
 
-	if (inputs[INDEXMOD_INPUT].getVoltage() == 0 || !inputs[INDEXMOD_INPUT].isConnected() || params[INDEXMODAMT_PARAM].getValue() == 0) {
-		clockedQuantBits = basedClockedQuantBits;
-	} else {
-		clockedQuantBits = basedClockedQuantBits + ((params[INDEXMODAMT_PARAM].getValue()/10.0f)*inputs[INDEXMOD_INPUT].getVoltage()*32767);
+	static float_4 wrapPhase(float_4 phase) {
+		return phase - simd::floor(phase);
 	}
 
-	clockedQuantBits = fmod(clockedQuantBits, 65534);
+	//same truncation as masking int16 samples, value rounded down to a multiple of step
+	static float_4 crushFloor(float_4 value, float_4 step) {
+		return simd::floor(value / step) * step;
+	}
 
-	if (clockedQuantBits < 0) {
-		clockedQuantBits = -clockedQuantBits; 
+	//antiderivative of crushFloor from 0, for the antialiased crush
+	static float_4 crushIntegral(float_4 value, float_4 step) {
+		float_4 k = simd::floor(value / step);
+		return step * k * (value - step * (k + 1.f) * 0.5f);
 	}
 
-	if (clockedQuantBits > 32767) {
-		clockedQuantBits = 65534 - clockedQuantBits; 
+	//every output the engines produce goes through these, so the bit crush knows which values are new this sample
+	void writeOutput(int o, float_4 voltage, int c) {
+		outputs[o].setVoltageSimd(voltage, c);
+		outputsWritten[o] |= 0xfu << c;
 	}
 
-	clockedQuantBits = clamp(clockedQuantBits, 0.f, 32767.0f);
+	void writeOutput(int o, float voltage, int c) {
+		outputs[o].setVoltage(voltage, c);
+		outputsWritten[o] |= 1u << c;
+	}
 
-	//bit rate
-	outputBits = params[BITS_PARAM].getValue();
-	bitMask = (1 << outputBits) - 1;
-	bitMask = bitMask << (16 - outputBits); 		
+	//bit reduction for every output in one pass, after all engines wrote their samples. the antialiased mode uses first
+	//order adaa: the average of the staircase over the last sample instead of a point on it, which takes out most of
+	//the aliasing for half a sample of delay. values nobody wrote this sample, like an engine still being built, were
+	//crushed already and are left alone
+	void processBitCrush() {
 
+		if (!bitCrushActive) {
+			std::fill(outputsWritten, outputsWritten + OUTPUTS_LEN, 0);
+			return;
+		}
 
+		//the quantized output is pitch, not audio, and stays as it is
+		for (int o = 0; o < QUANTIZED_OUTPUT; o++) {
 
-	//lfo mode handled by using if statement to decide if outputs should render
+			uint32_t written = outputsWritten[o];
+			outputsWritten[o] = 0;
 
-	if(lfoModeSkipCounter == 0 || !isLFOmode){
+			if (!outputs[o].isConnected()) {
+				continue;
+			}
 
-	//tri output
-	if(outputs[TRI_OUTPUT].isConnected()){
+			for (int c = 0; c < channels; c += 4) {
 
-		if(triOutputBuffer.empty()){
+				int lanes = (written >> c) & 0xf;
+				if (!lanes) {
+					continue;
+				}
+				float_4 fresh = simd::movemaskInverse<float_4>(lanes);
 
-			triOsc.set_shape((braids::MacroOscillatorShape) braids::MACRO_OSC_SHAPE_MORPH);
-			triOsc.set_parameters(0,0); //param1 for the oscillator mix. param2 is lp so 0 is full open
+				float_4 out = outputs[o].getVoltageSimd<float_4>(c);
+				float_4 in = out * 0.2f;
+				float_4 step = crushStep[c / 4];
+				float_4 x = in;
 
-		
+				//tpdf dither of one step
+				if (bitDither) {
+					uint32_t* state = noiseCores[c / 4].dither;
+					x += 0.5f * step * (xorshift(state) - xorshift(state));
+				}
 
-		triOsc.set_pitch(pitchBraids);
+				float_4 y;
+				if (bitCrushMode == CRUSH_ADAA) {
+					//both ends measured from the step below the last input keeps the integrals small, so they don't
+					//cancel out in float. the midpoint takes over where the difference is too small to divide by
+					float_4& last = crushLast[o][c / 4];
+					float_4 delta = x - last;
+					float_4 origin = crushFloor(last, step);
+					float_4 adaa = origin + (crushIntegral(x - origin, step) - crushIntegral(last - origin, step)) / delta;
+					y = simd::ifelse(simd::abs(delta) < 1e-3f * step, crushFloor(0.5f * (x + last), step), adaa);
+					last = simd::ifelse(fresh, x, last);
+				} else {
+					y = crushFloor(x, step);
+				}
 
-		uint8_t triSync_buffer[24] = {};
+				y = simd::ifelse(crushBypass[c / 4], out, 5.f * y);
+				outputs[o].setVoltageSimd(simd::ifelse(fresh, y, out), c);
+			}
+		}
+	}
 
-		int16_t triRender_buffer[24];
-		triOsc.Render(triSync_buffer, triRender_buffer, 24);
-		
-		// Apply bit reduction by masking the lower bits
-		for (int i = 0; i < 24; i++) {
-			triRender_buffer[i] &= bitMask; // Apply the generated mask to each sample
+	//counts the wraps of a phase over four cycles. a phase running backwards counts down
+	static float_4 countCycles(float_4 cycles, float_4 wraps) {
+		cycles += wraps;
+		cycles = simd::ifelse(cycles >= 4.f, cycles - 4.f, cycles);
+		return simd::ifelse(cycles < 0.f, cycles + 4.f, cycles);
+	}
+
+	float getSubRatio() {
+		return subOctave == SUB_TWO_DOWN ? 0.25f : subOctave == SUB_ONE_DOWN ? 0.5f : 2.f;
+	}
+
+	//sub phase from the main phase and its cycle count. it wraps exactly when the main phase does
+	float_4 getSubPhase(float_4 phase, float_4 cycles) {
+		if (subOctave == SUB_TWO_DOWN)
+			return (cycles + phase) * 0.25f;
+		if (subOctave == SUB_ONE_DOWN)
+			return (cycles - 2.f * simd::floor(cycles * 0.5f) + phase) * 0.5f;
+		return wrapPhase(phase * 2.f);
+	}
+
+	//phase increment of the voices c to c+3 for the cores that run at the engine rate
+	float_4 getPhaseIncrement(int c, float sampleTime) {
+
+		//same pitch range braids gets, 0V is C4
+		const float maxPitch = (16383.f / 128.f - 60.f) / 12.f;
+		float_4 freq;
+
+		if (isLINfm) {
+			//through-zero linear fm. the fm signal scales the carrier frequency, past -1 the phase runs backwards
+			float_4 pitchCV = simd::clamp(float_4::load(&basePitchCV[c]), -5.f, maxPitch);
+			freq = dsp::FREQ_C4 * dsp::approxExp2_taylor5(pitchCV) * (1.f + float_4::load(&fmSignal[c]));
+		} else {
+			float_4 pitchCV = simd::clamp(float_4::load(&sumPitchCV[c]), -5.f, maxPitch);
+			freq = dsp::FREQ_C4 * dsp::approxExp2_taylor5(pitchCV);
 		}
 
-		// Sample rate convert
-		dsp::Frame<1> triIn[24];
-		for (int i = 0; i < 24; i++) {
-			triIn[i].samples[0] = triRender_buffer[i] / 32768.0;
+		return simd::clamp(freq * sampleTime, -0.5f, 0.5f);
+	}
+
+	//one sample of the analog shapes and the sub for the voices c to c+3, rendered at the engine rate. fm is applied
+	//every sample. only for the native core, the braids shapes bring their own sub
+	void processAnalogCore(int c, float sampleTime) {
+
+		AnalogCore& core = analogCores[c / 4];
+
+		float_4 dt = getPhaseIncrement(c, sampleTime);
+
+		float_4 phase = core.phase + dt;
+		float_4 wraps = simd::floor(phase);
+		phase -= wraps;
+		core.cycles = countCycles(core.cycles, wraps);
+
+		//hard sync restarts the phase and the sub with it, from where the edge crossed within the sample. the phase at
+		//the edge is kept for the step correction
+		float_4 sync = syncEdges[c / 4];
+		float_4 frac = syncFraction[c / 4];
+		float_4 edgePhase = phase - frac * dt;
+		float_4 edgeWraps = simd::floor(edgePhase);
+		edgePhase -= edgeWraps;
+		float_4 edgeCycles = countCycles(core.cycles, edgeWraps);
+		core.phase = phase = simd::ifelse(sync, wrapPhase(frac * simd::fmax(dt, 0.f)), phase);
+		core.cycles = simd::ifelse(sync, 0.f, core.cycles);
+
+		//the residuals only depend on the distance to the edge, so they work the same for a phase running backwards
+		dt = simd::fmax(simd::abs(dt), 1e-6f);
+
+		if (outputs[TRI_OUTPUT].isConnected()) {
+			float_4 naive = simd::ifelse(phase < 0.5f, 4.f * phase - 1.f, 3.f - 4.f * phase);
+			float_4 tri = naive + 4.f * dt * (polyBlamp(phase, dt) - polyBlamp(wrapPhase(phase + 0.5f), dt));
+			float_4 before = simd::ifelse(edgePhase < 0.5f, 4.f * edgePhase - 1.f, 3.f - 4.f * edgePhase);
+			tri = syncStep(sync, frac, tri, naive, before, -1.f);
+			writeOutput(TRI_OUTPUT, 5.f * tri, c);
+		}
+
+		if (outputs[SAW_OUTPUT].isConnected()) {
+			float_4 naive = 2.f * phase - 1.f;
+			float_4 saw = syncStep(sync, frac, naive - polyBlep(phase, dt), naive, 2.f * edgePhase - 1.f, -1.f);
+			writeOutput(SAW_OUTPUT, 5.f * saw, c);
 		}
-		
-		
-		
-		triSRC.setRates(96000, args.sampleRate);
 
-		int triInLen = 24;
-		int triOutLen = triOutputBuffer.capacity();
-		triSRC.process(triIn, &triInLen, triOutputBuffer.endData(), &triOutLen);
-		triOutputBuffer.endIncr(triOutLen);
+		if (outputs[PULSE_OUTPUT].isConnected()) {
+			//braids narrows the pulse from 50% as its parameter goes up to 32000
+			float_4 duty = 0.5f - float_4::load(&pulseWidth[c]) / 65536.f;
+			float_4 naive = simd::ifelse(phase < duty, 1.f, -1.f);
+			float_4 pulse = naive + polyBlep(phase, dt) - polyBlep(wrapPhase(phase - duty + 1.f), dt);
+			pulse = syncStep(sync, frac, pulse, naive, simd::ifelse(edgePhase < duty, 1.f, -1.f), 1.f);
+			writeOutput(PULSE_OUTPUT, 5.f * pulse, c);
 		}
 
-		// Output triangle
-		if (!triOutputBuffer.empty()) {
-			dsp::Frame<1> triF = triOutputBuffer.shift();
-			outputs[TRI_OUTPUT].setVoltage(5.0 * triF.samples[0]);
+		if (outputs[SINE_OUTPUT].isConnected()) {
+			float_4 sine = simd::sin(2.f * float(M_PI) * phase);
+			sine = syncStep(sync, frac, sine, sine, simd::sin(2.f * float(M_PI) * edgePhase), 0.f);
+			writeOutput(SINE_OUTPUT, 5.f * sine, c);
 		}
 
+		if (outputs[SUBSQUARE_OUTPUT].isConnected()) {
+			float_4 subPhase = getSubPhase(phase, core.cycles);
+			float_4 subEdge = getSubPhase(edgePhase, edgeCycles);
+			float_4 subDt = simd::fmin(dt * getSubRatio(), 0.5f);
+			float_4 sub;
+			if (subShape == SUB_SAW) {
+				float_4 naive = 2.f * subPhase - 1.f;
+				sub = syncStep(sync, frac, naive - polyBlep(subPhase, subDt), naive, 2.f * subEdge - 1.f, -1.f);
+			} else {
+				float_4 naive = simd::ifelse(subPhase < 0.5f, 1.f, -1.f);
+				sub = naive + polyBlep(subPhase, subDt) - polyBlep(wrapPhase(subPhase + 0.5f), subDt);
+				sub = syncStep(sync, frac, sub, naive, simd::ifelse(subEdge < 0.5f, 1.f, -1.f), 1.f);
+			}
+			writeOutput(SUBSQUARE_OUTPUT, 5.f * sub, c);
+		}
 	}
 
+	bool isAnalogEngine(int engine) {
+		return engine <= SINE_ENGINE;
+	}
 
-	//saw output
-	if(outputs[SAW_OUTPUT].isConnected()){
+	//one sample of a loaded wavetable for the voices c to c+3. the mip level follows the frequency, so it never aliases
+	void processUserWavetable(int c, float sampleTime) {
 
-		if(sawOutputBuffer.empty()){
+		AnalogCore& core = analogCores[c / 4];
 
-			sawOsc.set_shape((braids::MacroOscillatorShape) braids::MACRO_OSC_SHAPE_MORPH);
-			sawOsc.set_parameters(10923,0);
+		float_4 dt = getPhaseIncrement(c, sampleTime);
+		float_4 phase = wrapPhase(core.wavetablePhase + dt);
+		phase = simd::ifelse(syncEdges[c / 4], 0.f, phase);
+		core.wavetablePhase = phase;
 
-		//pitch snippet was here if it stops working
+		//octaves above C4 of the frequency actually played, so through-zero fm picks the level too
+		float_4 octaves = simd::log2(simd::fmax(simd::abs(dt), 1e-6f) / (dsp::FREQ_C4 * sampleTime));
 
-		sawOsc.set_pitch(pitchBraids);
+		float_4 wave;
+		for (int i = 0; i < 4; i++) {
+			float level = std::ceil(wavetableLevelOffset + octaves[i]);
+			int l = clamp((int) level, 0, UserWavetable::LEVELS - 1);
+			wave[i] = userWavetable->read(l, wavetableIndex[c + i] / 32767.f, phase[i]);
+		}
+		writeOutput(WAVETABLE_OUTPUT, 5.f * wave, c);
+	}
 
-		uint8_t sawSync_buffer[24] = {};
+	//one sample of every pitched output in lfo mode, for the voices c to c+3. a few operations per shape
+	void processLfo(int c, float sampleTime) {
 
-		int16_t sawRender_buffer[24];
-		sawOsc.Render(sawSync_buffer, sawRender_buffer, 24);
-		
-		// Apply bit reduction by masking the lower bits
-		for (int i = 0; i < 24; i++) {
-			sawRender_buffer[i] &= bitMask;
-		}
-		
-		// Sample rate convert
+		LfoCore& lfo = lfoCores[c / 4];
 
-		dsp::Frame<1> sawIn[24];
-		for (int i = 0; i < 24; i++) {
-			sawIn[i].samples[0] = sawRender_buffer[i] / 32768.0;
-		}
-		sawSRC.setRates(96000, args.sampleRate);
+		float_4 pitchCV = simd::clamp(float_4::load(&sumPitchCV[c]), LFO_MIN_PITCH, LFO_MAX_PITCH);
+		float_4 delta = LFO_BASE_FREQ * dsp::approxExp2_taylor5(pitchCV) * sampleTime;
 
-		int sawInLen = 24;
-		int sawOutLen = sawOutputBuffer.capacity();
-		sawSRC.process(sawIn, &sawInLen, sawOutputBuffer.endData(), &sawOutLen);
-		sawOutputBuffer.endIncr(sawOutLen);
-		}
+		float_4 phase = lfo.phase + delta;
 
-		// Output saw
-		if (!sawOutputBuffer.empty()) {
-			dsp::Frame<1> sawF = sawOutputBuffer.shift();
-			outputs[SAW_OUTPUT].setVoltage(5.0 * sawF.samples[0]);
+		//new random values for the lanes that finished a cycle
+		for (int i = 0; i < 4; i++) {
+			if (phase[i] >= 1.f) {
+				lfo.randomFrom[i] = lfo.randomTo[i];
+				lfo.randomTo[i] = 2.f * random::uniform() - 1.f;
+			}
 		}
 
-	}
+		float_4 wraps = simd::floor(phase);
+		phase -= wraps;
+		lfo.cycles = countCycles(lfo.cycles, wraps);
 
-	//pulse output
-	if(outputs[PULSE_OUTPUT].isConnected()){
+		//sync works as an lfo reset
+		phase = simd::ifelse(syncEdges[c / 4], 0.f, phase);
+		lfo.phase = phase;
+		lfo.cycles = simd::ifelse(syncEdges[c / 4], 0.f, lfo.cycles);
 
-		if(pulseOutputBuffer.empty()){
+		if (outputs[TRI_OUTPUT].isConnected()) {
+			float_4 tri = simd::ifelse(phase < 0.5f, 4.f * phase - 1.f, 3.f - 4.f * phase);
+			writeOutput(TRI_OUTPUT, 5.f * tri, c);
+		}
 
-			pulseOsc.set_shape((braids::MacroOscillatorShape) braids::MACRO_OSC_SHAPE_SAW_SQUARE);
-			pulseOsc.set_parameters(pulseWidth,32767); //param1 for the phase. param2 is for the osc shape
+		if (outputs[SAW_OUTPUT].isConnected()) {
+			writeOutput(SAW_OUTPUT, 5.f * (2.f * phase - 1.f), c);
+		}
 
-		pulseOsc.set_pitch(pitchBraids);
+		if (outputs[PULSE_OUTPUT].isConnected()) {
+			float_4 duty = 0.5f - float_4::load(&pulseWidth[c]) / 65536.f;
+			writeOutput(PULSE_OUTPUT, 5.f * simd::ifelse(phase < duty, 1.f, -1.f), c);
+		}
 
-		uint8_t pulseSync_buffer[24] = {};
+		if (outputs[SINE_OUTPUT].isConnected()) {
+			writeOutput(SINE_OUTPUT, 5.f * simd::sin(2.f * float(M_PI) * phase), c);
+		}
 
-		int16_t pulseRender_buffer[24];
-		pulseOsc.Render(pulseSync_buffer, pulseRender_buffer, 24);
-		
-		// Apply bit reduction by masking the lower bits
-		for (int i = 0; i < 24; i++) {
-			pulseRender_buffer[i] &= bitMask;
+		if (outputs[SUBSQUARE_OUTPUT].isConnected()) {
+			float_4 subPhase = getSubPhase(phase, lfo.cycles);
+			float_4 sub = subShape == SUB_SAW ? 2.f * subPhase - 1.f : simd::ifelse(subPhase < 0.5f, 1.f, -1.f);
+			writeOutput(SUBSQUARE_OUTPUT, 5.f * sub, c);
 		}
-		
-		// Sample rate convert
 
-		dsp::Frame<1> pulseIn[24];
-		for (int i = 0; i < 24; i++) {
-			pulseIn[i].samples[0] = pulseRender_buffer[i] / 32768.0;
+		if (outputs[WAVETABLE_OUTPUT].isConnected()) {
+			//a loaded wavetable is used as is, at lfo rates the full band level is fine
+			const LfoWavetable& table = LfoWavetable::get();
+			float_4 wave;
+			for (int i = 0; i < 4; i++) {
+				if (userWavetable)
+					wave[i] = userWavetable->read(0, wavetableIndex[c + i] / 32767.f, phase[i]);
+				else
+					wave[i] = table.read(wavetableIndex[c + i] / 32767.f, phase[i]);
+			}
+			writeOutput(WAVETABLE_OUTPUT, 5.f * wave, c);
 		}
-		pulseSRC.setRates(96000, args.sampleRate);
 
-		int pulseInLen = 24;
-		int pulseOutLen = pulseOutputBuffer.capacity();
-		pulseSRC.process(pulseIn, &pulseInLen, pulseOutputBuffer.endData(), &pulseOutLen);
-		pulseOutputBuffer.endIncr(pulseOutLen);
+		if (outputs[PITCHEDNOISE_OUTPUT].isConnected()) {
+			float_4 smooth = phase * phase * (3.f - 2.f * phase);
+			float_4 glide = lfo.randomFrom + (lfo.randomTo - lfo.randomFrom) * smooth;
+			writeOutput(PITCHEDNOISE_OUTPUT, 5.f * glide, c);
 		}
 
-		// Output pulse
-		if (!pulseOutputBuffer.empty()) {
-			dsp::Frame<1> pulseF = pulseOutputBuffer.shift();
-			outputs[PULSE_OUTPUT].setVoltage(5.0 * pulseF.samples[0]);
+		if (outputs[CLOCKEDNOISE_OUTPUT].isConnected() && !externalNoiseClock) {
+			writeOutput(CLOCKEDNOISE_OUTPUT, 5.f * lfo.randomTo, c);
 		}
+	}
 
+	//the braids engines a rig needs for the outputs patched right now. the shapes that come from one of the other
+	//cores don't need one
+	int getActiveEngines(int* engines, bool tableLoaded) {
+		int numEngines = 0;
+		bool externalClock = inputs[SYNC_INPUT].isConnected() && syncTarget != SYNC_OSCILLATORS;
+		for (int i = 0; i < ENGINES_LEN; i++) {
+			bool isNative = (analogCore == NATIVE_CORE && (isAnalogEngine(i) || i == SUB_ENGINE)) || (i == WAVETABLE_ENGINE && tableLoaded) || (i == CLOCKEDNOISE_ENGINE && externalClock);
+			if (outputs[engineOutputs[i]].isConnected() && !isNative) {
+				engines[numEngines++] = i;
+			}
+		}
+		return numEngines;
 	}
 
-	//sine output. also the basis of the lfo lights if nothing is connected
-	if(outputs[SINE_OUTPUT].isConnected()){
+	//works out the engines of the next rig from the last one: engines in use carry over, unused ones stay for the grace
+	//time. false when that is the rig there already is. last may be NULL
+	bool planRig(Rig* last, const int* engines, int numEngines, int numVoices, Engine* slots[MAX_VOICES][ENGINES_LEN]) {
+		bool engineUsed[ENGINES_LEN] = {};
+		for (int k = 0; k < numEngines; k++) {
+			engineUsed[engines[k]] = true;
+		}
 
-		if(sineOutputBuffer.empty()){
+		bool changed = !last || numVoices != last->numVoices || numEngines != last->numActiveEngines
+			|| !std::equal(engines, engines + numEngines, last->activeEngines);
+		double now = system::getTime();
+
+		for (int c = 0; c < MAX_VOICES; c++) {
+			for (int e = 0; e < ENGINES_LEN; e++) {
+				Engine* old = last ? last->engines[c][e] : NULL;
+				bool used = c < numVoices && engineUsed[e];
+				//a converter is only set up for one rate and quality, an engine made for others is replaced
+				bool fits = old && old->srcQuality == srcQuality && old->sampleRate == engineSampleRate;
+
+				slots[c][e] = NULL;
+				if (fits && used) {
+					old->idleSince = -1.0;
+					slots[c][e] = old;
+				} else if (fits) {
+					if (old->idleSince < 0.0) {
+						old->idleSince = now;
+					}
+					if (now - old->idleSince < ENGINE_GRACE_TIME) {
+						slots[c][e] = old;
+					}
+				}
+				changed |= slots[c][e] != old || (used && !slots[c][e]);
+			}
+		}
+		return changed;
+	}
 
-			sineOsc.set_shape((braids::MacroOscillatorShape) braids::MACRO_OSC_SHAPE_HARMONICS);
-			sineOsc.set_parameters(0,0);
-			sineOsc.set_pitch(pitchBraids);
+	//builds a rig for the current settings and hands it to the audio thread. never called from the audio thread: it runs
+	//on cable and sample rate changes, from the menu, after a patch or a wavetable loads, and from the worker. nothing
+	//happens when the rig there already fits
+	void rebuildEngines() {
+		std::lock_guard<std::mutex> lock(rigMutex);
 
-		uint8_t sineSync_buffer[24] = {};
+		for (Rig* retired = retiredRigs.exchange(NULL); retired;) {
+			Rig* next = retired->nextRetired;
+			freeRig(retired);
+			retired = next;
+		}
 
-		int16_t sineRender_buffer[24];
-		sineOsc.Render(sineSync_buffer, sineRender_buffer, 24);
-		
-		// Apply bit reduction by masking the lower bits
-		for (int i = 0; i < 24; i++) {
-			sineRender_buffer[i] &= bitMask;
+		std::shared_ptr<const UserWavetable> wavetable;
+		{
+			std::lock_guard<std::mutex> tableLock(wavetableMutex);
+			wavetable = loadedWavetable;
 		}
-		
-		// Sample rate convert
 
-		dsp::Frame<1> sineIn[24];
-		for (int i = 0; i < 24; i++) {
-			sineIn[i].samples[0] = sineRender_buffer[i] / 32768.0;
+		int engines[ENGINES_LEN];
+		int numEngines = getActiveEngines(engines, (bool) wavetable);
+		int numVoices = 0;
+		if (numEngines > 0) {
+			numVoices = clamp(std::max(channelsInUse.load(), inputs[VOCT_INPUT].getChannels()), 1, MAX_VOICES);
+		}
+
+		Engine* slots[MAX_VOICES][ENGINES_LEN];
+		if (!planRig(rigs.empty() ? NULL : rigs.back(), engines, numEngines, numVoices, slots) && rigs.back()->wavetable == wavetable) {
+			return;
 		}
-		sineSRC.setRates(96000, args.sampleRate);
 
-		int sineInLen = 24;
-		int sineOutLen = sineOutputBuffer.capacity();
-		sineSRC.process(sineIn, &sineInLen, sineOutputBuffer.endData(), &sineOutLen);
-		sineOutputBuffer.endIncr(sineOutLen);
+		//a rig the audio thread did not pick up yet is replaced. the plan is made again against the rig in use, since
+		//the engines only the replaced one had are gone with it
+		Rig* pending = pendingRig.exchange(NULL);
+		if (pending) {
+			freeRig(pending);
+			planRig(rigs.empty() ? NULL : rigs.back(), engines, numEngines, numVoices, slots);
 		}
 
-		// Output sine
-		if (!sineOutputBuffer.empty()) {
-			dsp::Frame<1> sineF = sineOutputBuffer.shift();
-			outputs[SINE_OUTPUT].setVoltage(5.0 * sineF.samples[0]);
+		Rig* next = new Rig;
+		std::copy(engines, engines + numEngines, next->activeEngines);
+		next->numActiveEngines = numEngines;
+		next->numVoices = numVoices;
+		next->wavetable = wavetable;
+		for (int c = 0; c < MAX_VOICES; c++) {
+			for (int e = 0; e < ENGINES_LEN; e++) {
+				next->engines[c][e] = slots[c][e];
+			}
+		}
+		for (int c = 0; c < numVoices; c++) {
+			for (int k = 0; k < numEngines; k++) {
+				int e = engines[k];
+				if (!next->engines[c][e]) {
+					next->engines[c][e] = acquireEngine(engineShapes[e]);
+				}
+			}
 		}
 
+		rigs.push_back(next);
+		pendingRig = next;
 	}
 
-	//subSQ output
-	if(outputs[SUBSQUARE_OUTPUT].isConnected()){
+	//gives the engines of a rig back to the pool, unless another rig still has them
+	void freeRig(Rig* old) {
+		rigs.erase(std::find(rigs.begin(), rigs.end(), old));
+		for (int c = 0; c < MAX_VOICES; c++) {
+			for (int e = 0; e < ENGINES_LEN; e++) {
+				Engine* engine = old->engines[c][e];
+				bool shared = false;
+				for (Rig* other : rigs) {
+					shared |= other->engines[c][e] == engine;
+				}
+				if (engine && !shared) {
+					EnginePool<Engine>::get().release(engine);
+				}
+			}
+		}
+		delete old;
+	}
 
-		if(subSQOutputBuffer.empty()){
+	//an engine from the pool may still hold another module's oscillator and audio, all of it starts over
+	Engine* acquireEngine(braids::MacroOscillatorShape shape) {
+		Engine* engine = EnginePool<Engine>::get().acquire();
+		std::memset((void*) &engine->osc, 0, sizeof(engine->osc));
+		engine->osc.Init();
+		engine->osc.set_shape(shape);
+		engine->src.setQuality(srcQualityLevels[srcQuality]);
+		engine->src.setRates(96000, engineSampleRate);
+		engine->src.refreshState();
+		engine->outputBuffer.clear();
+		std::memset(engine->syncBuffer, 0, sizeof(engine->syncBuffer));
+		engine->syncTime = 0.f;
+		engine->srcQuality = srcQuality;
+		engine->sampleRate = engineSampleRate;
+		engine->idleSince = -1.0;
+		return engine;
+	}
 
-			subSQOsc.set_shape((braids::MacroOscillatorShape) braids::MACRO_OSC_SHAPE_SAW_SQUARE);
-			subSQOsc.set_parameters(0,32767);
-		subSQOsc.set_pitch((sumPitchCV * 12.0 + 48) * 128); //just adjusting down two octaves
+	//picks up a new rig at control rate. the old one goes on the retired list with a compare and swap, for the worker
+	//to free
+	void updateRig() {
+		Rig* next = pendingRig.exchange(NULL);
+		if (!next) {
+			return;
+		}
+		if (rig) {
+			Rig* retired = retiredRigs.load();
+			do {
+				rig->nextRetired = retired;
+			} while (!retiredRigs.compare_exchange_weak(retired, rig));
+		}
+		rig = next;
+		userWavetable = rig->wavetable.get();
+	}
 
-		uint8_t subSQSync_buffer[24] = {};
+	void onPortChange(const PortChangeEvent& e) override {
+		ControlRateModule::onPortChange(e);
+		rebuildEngines();
+	}
 
-		int16_t subSQRender_buffer[24];
-		subSQOsc.Render(subSQSync_buffer, subSQRender_buffer, 24);
-		
-		// Apply bit reduction by masking the lower bits
-		for (int i = 0; i < 24; i++) {
-			subSQRender_buffer[i] &= bitMask;
-		}
-		
-		// Sample rate convert
+	void onSampleRateChange(const SampleRateChangeEvent& e) override {
+		ControlRateModule::onSampleRateChange(e);
+		engineSampleRate = e.sampleRate;
+		rebuildEngines();
+	}
 
-		dsp::Frame<1> subSQIn[24];
-		for (int i = 0; i < 24; i++) {
-			subSQIn[i].samples[0] = subSQRender_buffer[i] / 32768.0;
-		}
-		subSQSRC.setRates(96000, args.sampleRate);
+	//control rate work, once per block: buttons, quantizer, lights, pulse width and index. pitch and pulse width get a
+	//target for the end of the block and the per sample steps to glide there
+	void processControls(const ProcessArgs& args) {
 
-		int subSQInLen = 24;
-		int subSQOutLen = subSQOutputBuffer.capacity();
-		subSQSRC.process(subSQIn, &subSQInLen, subSQOutputBuffer.endData(), &subSQOutLen);
-		subSQOutputBuffer.endIncr(subSQOutLen);
+	//octave buttons
+	if(octUpButton.process(params[OCTUP_PARAM].getValue())){
+		if(octOffsetButtons < 5){
+			octOffsetButtons++;
 		}
+	}
 
-		// Output subSQ
-		if (!subSQOutputBuffer.empty()) {
-			dsp::Frame<1> subSQF = subSQOutputBuffer.shift();
-			outputs[SUBSQUARE_OUTPUT].setVoltage(5.0 * subSQF.samples[0]);
+	if(octDownButton.process(params[OCTDOWN_PARAM].getValue())){
+		if(octOffsetButtons > -5){
+			octOffsetButtons--;
 		}
+	}
 
+	//toggle FM Mode
+	if(fmModeButton.process(params[FMLINEXPTOGGLE_PARAM].getValue())){
+		isLINfm = !isLINfm; //shorthand for inverting bool values in c++
 	}
+	
+	//toggle LFO Mode
+	if(lfoModeButton.process(params[LFOMODETOGGLE_PARAM].getValue())){
+		isLFOmode = !isLFOmode;
+	}
+	
 
-	//WLIN output
-	if(outputs[WAVETABLE_OUTPUT].isConnected()){
+	wavetableLevelOffset = std::log2(2.f * UserWavetable::harmonics(0) * dsp::FREQ_C4 * args.sampleTime);
 
-		if(WLINOutputBuffer.empty()){
+	//pick up a scala tuning loadScala finished. try_lock, the audio thread never waits for it
+	if(scalaPending && scalaMutex.try_lock()){
+		scalaTuning.swap(pendingScala);
+		scalaPending = false;
+		scalaMutex.unlock();
+	}
 
-			WLINOsc.set_shape((braids::MacroOscillatorShape) braids::MACRO_OSC_SHAPE_WAVE_LINE);
-			WLINOsc.set_parameters(wavetableIndex,24575); //param 1 gives the index location, param 2 defines the interpolation method. 24575 gives a clean blend/interpolation of waves and samples.
-			WLINOsc.set_pitch(pitchBraids);
+	//calculate pitch cv, allowing for quantization before FM modulation
+	quantizerScale = params[QNTSCALE_PARAM].getValue();
+	quantizerRoot = (params[QNTROOT_PARAM].getValue()+60)*128;
 
-		uint8_t WLINSync_buffer[24] = {};
+	//with a scala tuning loaded any scale but Off plays the tuning, its table is ready made
+	if(quantizerScale != 0 && (quantizerScale != lastQuantizerScale || quantizerRoot != lastQuantizerRoot || scalaTuning.get() != lastScalaTuning)){
+		if(!scalaTuning){
+			quantizerTable.build(braids::scales[quantizerScale], quantizerRoot);
+		}
+		std::fill(quantizerCodewords, quantizerCodewords + MAX_VOICES, -1);
+		lastQuantizerScale = quantizerScale;
+		lastQuantizerRoot = quantizerRoot;
+		lastScalaTuning = scalaTuning.get();
+	}
 
-		int16_t WLINRender_buffer[24];
-		WLINOsc.Render(WLINSync_buffer, WLINRender_buffer, 24);
-		
-		// Apply bit reduction by masking the lower bits
-		for (int i = 0; i < 24; i++) {
-			WLINRender_buffer[i] &= bitMask;
+	channels = std::max(inputs[VOCT_INPUT].getChannels(), 1);
+
+	pitchOffset = params[COARSETUNE_PARAM].getValue() + octOffsetButtons + (params[FINETUNE_PARAM].getValue()/12);
+	fmAmount = params[FMAMT_PARAM].getValue();
+
+	//voices run four at a time in float_4 lanes
+	for (int c = 0; c < channels; c += 4) {
+
+		float_4 pitchCV = getPitchCV(c); //before fm mod applied
+		pitchCV.store(&blockPitchCV[c]);
+
+		//process() does not run the pitch in quantizer only mode, the octave leds follow from here
+		if(quantizerOnly){
+			pitchCV.store(&sumPitchCV[c]);
 		}
-		
-		// Sample rate convert
 
-		dsp::Frame<1> WLINIn[24];
-		for (int i = 0; i < 24; i++) {
-			WLINIn[i].samples[0] = WLINRender_buffer[i] / 32768.0;
+		//fm is added per sample in process()
+		((pitchCV - float_4::load(&basePitchCV[c])) / (float) controlDivision).store(&basePitchStep[c]);
+	}
+
+	if(quantizerScale != 0){
+
+		// Determine the quantized note of the first voice based on the processed pitch
+		int quantizedNote = static_cast<int>(quantizedPitchBraids / 128.0f) % 12; // Get the note number in the range 0-11
+
+		// Update the lights based on the current scale and root
+		updateLights(quantizedNote);
+	}else{
+		 // all lights are off when the quantizer is off
+		for (int i = 0; i < 12; ++i) {
+			lights[keyLights[i]+0].setBrightness(0.0f); // off
+			lights[keyLights[i]+1].setBrightness(0.0f); 
+			lights[keyLights[i]+2].setBrightness(0.0f); 
 		}
-		WLINSRC.setRates(96000, args.sampleRate);
+	}
+
+	//pitch led light logic
+	if(lastPitchLEDcv != sumPitchCV[0] || isLFOmode || isLFOmode != lastLFOmode){ 
+		
+		if(isLFOmode){
+
+			numConnected = 0.001f;
+			if(outputs[TRI_OUTPUT].isConnected()){
+				numConnected++;
+			}
+			if(outputs[SAW_OUTPUT].isConnected()){
+				numConnected++;
+			}
+			if(outputs[PULSE_OUTPUT].isConnected()){
+				numConnected++;
+			}
+			if(outputs[SINE_OUTPUT].isConnected()){
+				numConnected++;
+			}
+			if(outputs[SUBSQUARE_OUTPUT].isConnected()){
+				numConnected++;
+			}
+			if(outputs[WAVETABLE_OUTPUT].isConnected()){
+				numConnected++;
+			}
+
+			numConnected = clamp(numConnected, 0.001f, 10.f); //lookout for divide by zero errors!
+			
+			if(numConnected > 0.001 && numConnected < 1.9){
+			posNegLEDvalue = ((outputs[TRI_OUTPUT].getVoltage()+outputs[SAW_OUTPUT].getVoltage()+outputs[PULSE_OUTPUT].getVoltage()+outputs[SINE_OUTPUT].getVoltage()+outputs[SUBSQUARE_OUTPUT].getVoltage()+outputs[WAVETABLE_OUTPUT].getVoltage())/(numConnected+.001f))*1.1;
+			}else{
+				if(outputs[SINE_OUTPUT].isConnected()){
+					posNegLEDvalue = outputs[SINE_OUTPUT].getVoltage()*1.1;	
+				}else if(outputs[TRI_OUTPUT].isConnected()){
+					posNegLEDvalue = outputs[TRI_OUTPUT].getVoltage()*1.1;
+				}else if(outputs[SAW_OUTPUT].isConnected()){
+					posNegLEDvalue = outputs[SAW_OUTPUT].getVoltage()*1.1;
+				}else if(outputs[PULSE_OUTPUT].isConnected()){
+					posNegLEDvalue = outputs[PULSE_OUTPUT].getVoltage()*1.1;
+				}else if(outputs[SUBSQUARE_OUTPUT].isConnected()){
+					posNegLEDvalue = outputs[SUBSQUARE_OUTPUT].getVoltage()*1.1;
+				}else if(outputs[WAVETABLE_OUTPUT].isConnected()){
+					posNegLEDvalue = outputs[WAVETABLE_OUTPUT].getVoltage()*1.1;
+				}else{
+					posNegLEDvalue = 0;
+				}
+			}
 
-		int WLINInLen = 24;
-		int WLINOutLen = WLINOutputBuffer.capacity();
-		WLINSRC.process(WLINIn, &WLINInLen, WLINOutputBuffer.endData(), &WLINOutLen);
-		WLINOutputBuffer.endIncr(WLINOutLen);
+			lastLFOmode = isLFOmode;
+		}else{
+			posNegLEDvalue = sumPitchCV[0];
 		}
 
-		// Output WLIN
-		if (!WLINOutputBuffer.empty()) {
-			dsp::Frame<1> WLINF = WLINOutputBuffer.shift();
-			outputs[WAVETABLE_OUTPUT].setVoltage(5.0 * WLINF.samples[0]);
+		//negative values light N1 outwards, positive values P1 outwards, one led per volt. the center led is on in between
+		int negLEDs = posNegLEDvalue <= -1 ? std::min((int) std::floor(-posNegLEDvalue), 5) : 0;
+		int posLEDs = posNegLEDvalue >= 1 ? std::min((int) std::floor(posNegLEDvalue), 5) : 0;
+
+		for (int k = 1; k <= 5; k++) {
+			lights[ZEROLED_LIGHT - k].setBrightness(k <= negLEDs ? 1.0f : 0.0f);
+			lights[ZEROLED_LIGHT + k].setBrightness(k <= posLEDs ? 1.0f : 0.0f);
 		}
+		lights[ZEROLED_LIGHT].setBrightness(negLEDs == 0 && posLEDs == 0 ? 1.0f : 0.0f);
 
-	}		
+	} //end of LED statements
 
-	//pitchedNoise output
-	if(outputs[PITCHEDNOISE_OUTPUT].isConnected()){
 
-		if(pitchedNoiseOutputBuffer.empty()){
+	lastPitchLEDcv = sumPitchCV[0]; //this goes after the LEDs are processed. if they are equal the next process, the led logic will not be looked at.
 
-			pitchedNoiseOsc.set_shape((braids::MacroOscillatorShape) braids::MACRO_OSC_SHAPE_FILTERED_NOISE);
-			pitchedNoiseOsc.set_parameters(16385,16385); //param1 for the resonance. param2 is for the filter mode
+	//get the pulse width, wavetable index and clocked noise settings per voice. pw goes to cycle length, index goes to quantize bits amount for the clocked noise
+	//a disconnected input reads 0V, so the modulation terms drop out without extra checks
 
-		
+	float basedPulseWidth = 32000 * (std::abs(params[PULSEWIDTH_PARAM].getValue())); //center point
+	float basedClockedNoiseCycleLength = 32767 * (std::abs(params[PULSEWIDTH_PARAM].getValue()));
+	float basedIndex = 32767 * params[INDEX_PARAM].getValue(); //this is the center point / starting index before modulation
+	float pwmAmount = params[PWMAMT_PARAM].getValue();
+	float indexModAmount = params[INDEXMODAMT_PARAM].getValue();
+	float bitsKnob = params[BITS_PARAM].getValue();
+	bool modIndex = indexModTarget != INDEXMOD_BITS;
+	bool modBits = indexModTarget != INDEXMOD_INDEX;
+	bitCrushActive = false;
 
-		pitchedNoiseOsc.set_pitch(pitchBraids);
+	for (int c = 0; c < channels; c += 4) {
 
-		uint8_t pitchedNoiseSync_buffer[24] = {};
+		float_4 pwmCV = inputs[PWM_INPUT].getPolyVoltageSimd<float_4>(c);
+		float_4 modCV = inputs[INDEXMOD_INPUT].getPolyVoltageSimd<float_4>(c);
+		float_4 indexCV = modIndex ? modCV : 0.f;
 
-		int16_t pitchedNoiseRender_buffer[24];
-		pitchedNoiseOsc.Render(pitchedNoiseSync_buffer, pitchedNoiseRender_buffer, 24);
-		
-		// Apply bit reduction by masking the lower bits
-		for (int i = 0; i < 24; i++) {
-			pitchedNoiseRender_buffer[i] &= bitMask;
+		//bit depth, 1.5 bits per volt at full amount so 10V sweeps the whole range. in between depths give in between
+		//step sizes, so modulation doesn't jump
+		float_4 bits = simd::clamp(bitsKnob + (modBits ? indexModAmount * modCV * 1.5f : 0.f), 1.f, 16.f);
+		crushBypass[c / 4] = bits >= 16.f;
+		crushStep[c / 4] = simd::pow(2.f, 1.f - bits);
+		for (int i = 0; i < 4 && c + i < channels; i++) {
+			bitCrushActive |= bits[i] < 16.f;
 		}
-		
-		// Sample rate convert
 
-		dsp::Frame<1> pitchedNoiseIn[24];
-		for (int i = 0; i < 24; i++) {
-			pitchedNoiseIn[i].samples[0] = pitchedNoiseRender_buffer[i] / 32768.0;
-		}
-		pitchedNoiseSRC.setRates(96000, args.sampleRate);
+		float_4 pw = basedPulseWidth + (simd::abs(pwmCV / 5.0f) * pwmAmount * 32000);
+		pw = simd::clamp(pw, 0.f, 32000.0f);
+		((pw - float_4::load(&pulseWidth[c])) / (float) controlDivision).store(&pulseWidthStep[c]);
+
+		// Get the wavetable index value. this should allow smooth modulation with incoming negative voltage even when index is 0
+		reflectIndex(basedIndex + ((indexModAmount / 15.0f) * indexCV * 32767)).store(&wavetableIndex[c]);
+
+		reflectIndex(basedClockedNoiseCycleLength + ((pwmAmount / 10.0f) * pwmCV * 32767)).store(&clockedNoiseCycleLength[c]);
 
-		int pitchedNoiseInLen = 24;
-		int pitchedNoiseOutLen = pitchedNoiseOutputBuffer.capacity();
-		pitchedNoiseSRC.process(pitchedNoiseIn, &pitchedNoiseInLen, pitchedNoiseOutputBuffer.endData(), &pitchedNoiseOutLen);
-		pitchedNoiseOutputBuffer.endIncr(pitchedNoiseOutLen);
+		reflectIndex(basedIndex + ((indexModAmount / 10.0f) * indexCV * 32767)).store(&clockedQuantBits[c]);
+	}
+
+	//in quantizer only mode the oscillator outputs go to one silent channel, so nothing patched to them keeps a stale voltage
+	for (int i = 0; i < OUTPUTS_LEN; i++) {
+		if(quantizerOnly && i != QUANTIZED_OUTPUT){
+			outputs[i].setChannels(1);
+			outputs[i].setVoltage(0.f);
+		}else{
+			outputs[i].setChannels(channels);
 		}
+	}
 
-		// Output pitchedNoise
-		if (!pitchedNoiseOutputBuffer.empty()) {
-			dsp::Frame<1> pitchedNoiseF = pitchedNoiseOutputBuffer.shift();
-			outputs[PITCHEDNOISE_OUTPUT].setVoltage(5.0 * pitchedNoiseF.samples[0]);
+	externalNoiseClock = inputs[SYNC_INPUT].isConnected() && syncTarget != SYNC_OSCILLATORS;
+
+	updateRig();
+	channelsInUse = channels;
+
+	//like the braids engines, the core only runs while something is patched to it. with the braids shapes every
+	//output it could feed, the sub included, comes from braids
+	analogCoreActive = false;
+	for (int i = 0; i < ENGINES_LEN && analogCore == NATIVE_CORE; i++) {
+		analogCoreActive |= (isAnalogEngine(i) || i == SUB_ENGINE) && outputs[engineOutputs[i]].isConnected();
+	}
+
+	if(noiseReseed){
+		seedNoise();
+		noiseReseed = false;
+	}
+
+	}
+
+	//main process
+	void process(const ProcessArgs& args) override {
+
+	bool controlSample = processControlRate();
+	if(controlSample){
+		processControls(args);
+	}
+
+	//the quantized output follows the v/oct input every sample, without glide or fm. the quantizer runs once per
+	//sample, on control samples processControls already did it
+	if(outputs[QUANTIZED_OUTPUT].isConnected()){
+		for (int c = 0; c < channels; c += 4) {
+			float_4 pitchCV = controlSample ? float_4::load(&blockPitchCV[c]) : getPitchCV(c);
+			outputs[QUANTIZED_OUTPUT].setVoltageSimd(pitchCV, c);
 		}
+	}
 
+	//in quantizer only mode that is all there is to do
+	if(quantizerOnly){
+		return;
 	}
 
-	//clocked noise output
-	if(outputs[CLOCKEDNOISE_OUTPUT].isConnected()){
+	//glide pitch and pulse width towards the block targets. fm stays per sample so audio rate modulation keeps working
+	for (int c = 0; c < channels; c += 4) {
 
-		if(clockedNoiseOutputBuffer.empty()){
+		float_4 pitchCV = float_4::load(&basePitchCV[c]) + float_4::load(&basePitchStep[c]);
+		pitchCV.store(&basePitchCV[c]);
 
-			clockedNoiseOsc.set_shape((braids::MacroOscillatorShape) braids::MACRO_OSC_SHAPE_CLOCKED_NOISE);
-			clockedNoiseOsc.set_parameters(clockedNoiseCycleLength,clockedQuantBits); //param1 for the cycle length. param2 is for the quantized bits
+		//add FM modulation based on active mode. linear fm scales the frequency on every core. the native core runs
+		//through zero, braids and the lfo can't run backwards and follow the magnitude of the frequency
+		float_4 fm = fmAmount * inputs[FM_INPUT].getPolyVoltageSimd<float_4>(c);
+		fm.store(&fmSignal[c]);
 
-		
+		if(isLINfm){ 
+			pitchCV += simd::log2(simd::fmax(simd::abs(1.f + fm), 1e-3f));
+		}else{
+			pitchCV += dsp::approxExp2_taylor5(fm) - 1.f;
+		}
 
-		clockedNoiseOsc.set_pitch(pitchBraids);
+		pitchCV.store(&sumPitchCV[c]);
 
-		uint8_t clockedNoiseSync_buffer[24] = {};
+		float_4 pitch = simd::clamp((pitchCV * 12.f + 60.f) * 128.f, 0.f, 16383.f);
 
-		int16_t clockedNoiseRender_buffer[24];
-		clockedNoiseOsc.Render(clockedNoiseSync_buffer, clockedNoiseRender_buffer, 24);
-		
-		// Apply bit reduction by masking the lower bits
-		for (int i = 0; i < 24; i++) {
-			clockedNoiseRender_buffer[i] &= bitMask;
+		for (int i = 0; i < 4; i++) {
+			pitchBraids[c + i] = pitch[i];
 		}
-		
-		// Sample rate convert
 
-		dsp::Frame<1> clockedNoiseIn[24];
-		for (int i = 0; i < 24; i++) {
-			clockedNoiseIn[i].samples[0] = clockedNoiseRender_buffer[i] / 32768.0;
+		(float_4::load(&pulseWidth[c]) + float_4::load(&pulseWidthStep[c])).store(&pulseWidth[c]);
+
+		if(inputs[SYNC_INPUT].isConnected()){
+			float_4 sync = inputs[SYNC_INPUT].getPolyVoltageSimd<float_4>(c);
+			float_4 edges = syncTriggers[c / 4].process(sync, 0.1f, 1.f);
+			syncEdges[c / 4] = syncTarget != SYNC_NOISE_CLOCK ? edges : 0.f;
+			syncFraction[c / 4] = simd::clamp((sync - 1.f) / simd::fmax(sync - syncLast[c / 4], 1e-6f), 0.f, 1.f);
+			syncLast[c / 4] = sync;
+			clockEdges[c / 4] = edges;
+		}else{
+			syncEdges[c / 4] = 0.f;
+			clockEdges[c / 4] = 0.f;
 		}
-		clockedNoiseSRC.setRates(96000, args.sampleRate);
+	}
 
-		int clockedNoiseInLen = 24;
-		int clockedNoiseOutLen = clockedNoiseOutputBuffer.capacity();
-		clockedNoiseSRC.process(clockedNoiseIn, &clockedNoiseInLen, clockedNoiseOutputBuffer.endData(), &clockedNoiseOutLen);
-		clockedNoiseOutputBuffer.endIncr(clockedNoiseOutLen);
+	//the external clock drives the digital noise in both modes
+	if(externalNoiseClock && outputs[CLOCKEDNOISE_OUTPUT].isConnected()){
+		for (int c = 0; c < channels; c += 4) {
+			processClockedNoise(c);
 		}
+	}
 
-		// Output clockedNoise
-		if (!clockedNoiseOutputBuffer.empty()) {
-			dsp::Frame<1> clockedNoiseF = clockedNoiseOutputBuffer.shift();
-			outputs[CLOCKEDNOISE_OUTPUT].setVoltage(5.0 * clockedNoiseF.samples[0]);
+	//lfo mode runs its own engine and leaves braids and the native core alone
+	if(isLFOmode){
+		for (int c = 0; c < channels; c += 4) {
+			processLfo(c, args.sampleTime);
 		}
+	}else{
 
+	if(analogCoreActive){
+		for (int c = 0; c < channels; c += 4) {
+			processAnalogCore(c, args.sampleTime);
+		}
 	}
-	
-	} //encloses the outputs affected by LFO mode
 
-	lfoModeSkipThreshold = args.sampleRate / 48000.0f * 100.0f; // scales threshold based on sample rate. confirmed working pretty okayish
-	lfoModeSkipCounter++;
-
-	if(lfoModeSkipCounter > lfoModeSkipThreshold || !isLFOmode){ // makes the output only 1/100th of regular mode in 48khz. then this ratio is maintained for other sample rates. sounds like an ok range, maybe this could be tweaked one day. good for now.
-		lfoModeSkipCounter = 0;
+	if(userWavetable && outputs[WAVETABLE_OUTPUT].isConnected()){
+		for (int c = 0; c < channels; c += 4) {
+			processUserWavetable(c, args.sampleTime);
+		}
 	}
 
-	
-	// Noise output. Put this after the lfo mode so it doesn't affect it
-	if(outputs[NOISE_OUTPUT].isConnected()){
+	for (int k = 0; rig && k < rig->numActiveEngines; k++) {
 
-		if(NoiseOutputBuffer.empty()){
+		int e = rig->activeEngines[k];
 
-			NoiseOsc.set_shape((braids::MacroOscillatorShape) braids::MACRO_OSC_SHAPE_FILTERED_NOISE);
-			NoiseOsc.set_parameters(0,26216); //param1 for the resonance. param2 is for the filter mode
+		for (int c = 0; c < channels; c++) {
 
-		
+			//voices the channels just grew into are silent until the worker built their engines
+			if (c >= rig->numVoices) {
+				writeOutput(engineOutputs[e], 0.f, c);
+				continue;
+			}
 
-		NoiseOsc.set_pitch(7680);
+			Engine& engine = *rig->engines[c][e];
 
-		uint8_t NoiseSync_buffer[24] = {};
+			//an edge lands in the next block at the same distance from its start as it had from the last render
+			if (simd::movemask(syncEdges[c / 4]) & (1 << (c % 4))) {
+				engine.syncBuffer[std::min((int) engine.syncTime, 23)] = 1;
+			}
+			engine.syncTime += 96000.f * args.sampleTime;
 
-		int16_t NoiseRender_buffer[24];
-		NoiseOsc.Render(NoiseSync_buffer, NoiseRender_buffer, 24);
-		
-		// Apply bit reduction by masking the lower bits
-		for (int i = 0; i < 24; i++) {
-			NoiseRender_buffer[i] &= bitMask;
-		}
-		
-		// Sample rate convert
+			if (engine.outputBuffer.empty()) {
+				renderEngine(c, e, engine);
+			}
 
-		dsp::Frame<1> NoiseIn[24];
-		for (int i = 0; i < 24; i++) {
-			NoiseIn[i].samples[0] = NoiseRender_buffer[i] / 32768.0;
+			if (!engine.outputBuffer.empty()) {
+				writeOutput(engineOutputs[e], 5.f * engine.outputBuffer.shift().samples[0], c);
+			}
 		}
-		NoiseSRC.setRates(96000, args.sampleRate);
+	}
 
-		int NoiseInLen = 24;
-		int NoiseOutLen = NoiseOutputBuffer.capacity();
-		NoiseSRC.process(NoiseIn, &NoiseInLen, NoiseOutputBuffer.endData(), &NoiseOutLen);
-		NoiseOutputBuffer.endIncr(NoiseOutLen);
-		}
+	} //encloses the outputs affected by LFO mode
 
-		// Output Noise
-		if (!NoiseOutputBuffer.empty()) {
-			dsp::Frame<1> NoiseF = NoiseOutputBuffer.shift();
-			outputs[NOISE_OUTPUT].setVoltage(5.0 * NoiseF.samples[0]);
+	// Noise output. Put this after the lfo mode so it doesn't affect it
+	if(outputs[NOISE_OUTPUT].isConnected()){
+		for (int c = 0; c < channels; c += 4) {
+			processNoise(c);
 		}
-
 	}
 	
+	//bit reduction goes last, over everything the engines wrote
+	processBitCrush();
+
 	} //don't delete this. end of process
 
 };
@@ -1186,6 +1894,8 @@ struct BaseOscWidget : ModuleWidget {
 		addInput(createInputCentered<CL1362Port>(mm2px(Vec(23.336, 66.718)), module, BaseOsc::FM_INPUT));
 		addInput(createInputCentered<CL1362Port>(mm2px(Vec(37.624, 66.718)), module, BaseOsc::PWM_INPUT));
 		addInput(createInputCentered<CL1362Port>(mm2px(Vec(51.913, 66.718)), module, BaseOsc::INDEXMOD_INPUT));
+		addInput(createInputCentered<CL1362Port>(mm2px(Vec(9.047, 11.5)), module, BaseOsc::SYNC_INPUT));
+		addOutput(createOutputCentered<CL1362Port>(mm2px(Vec(51.913, 11.5)), module, BaseOsc::QUANTIZED_OUTPUT));
 
 		addOutput(createOutputCentered<CL1362Port>(mm2px(Vec(9.047, 81.33)), module, BaseOsc::TRI_OUTPUT));
 		addOutput(createOutputCentered<CL1362Port>(mm2px(Vec(23.336, 81.33)), module, BaseOsc::SAW_OUTPUT));
@@ -1221,6 +1931,113 @@ struct BaseOscWidget : ModuleWidget {
 		addChild(createLightCentered<TinyLight<RedGreenBlueLight>>(mm2px(Vec(53.623, 43.146)), module, BaseOsc::QNTLEDA_LIGHT));
 		addChild(createLightCentered<TinyLight<RedGreenBlueLight>>(mm2px(Vec(57.038, 43.146)), module, BaseOsc::QNTLEDB_LIGHT));
 	}
+
+	void appendContextMenu(Menu* menu) override {
+		BaseOsc* module = getModule<BaseOsc>();
+
+		menu->addChild(new MenuSeparator);
+		menu->addChild(createIndexSubmenuItem("Analog shapes", {"Braids (96kHz, resampled)", "Native rate (band-limited)"},
+			[=]() {return module->analogCore;},
+			[=](size_t core) {
+				module->analogCore = core;
+				module->rebuildEngines();
+			}
+		));
+
+		menu->addChild(createIndexPtrSubmenuItem("Sub shape", {"Square", "Saw"}, &module->subShape));
+		menu->addChild(createIndexPtrSubmenuItem("Sub octave", {"2 octaves down", "1 octave down", "1 octave up"}, &module->subOctave));
+		menu->addChild(createIndexPtrSubmenuItem("Noise color", {"White", "Pink", "Brown"}, &module->noiseColor));
+		menu->addChild(createBoolMenuItem("Fixed noise seed", "",
+			[=]() {return module->fixedNoiseSeed;},
+			[=](bool fixed) {
+				//start the fixed sequence right away, so a render made now matches one made after reloading
+				module->fixedNoiseSeed = fixed;
+				module->noiseReseed = fixed;
+			}
+		));
+		menu->addChild(createIndexPtrSubmenuItem("Bit reduction", {"Plain", "Antialiased"}, &module->bitCrushMode));
+		menu->addChild(createBoolPtrMenuItem("Bit reduction dither", "", &module->bitDither));
+		menu->addChild(createIndexPtrSubmenuItem("Index Mod input", {"Index", "Bit depth", "Index and bit depth"}, &module->indexModTarget));
+		menu->addChild(createIndexSubmenuItem("Sync input", {"Hard sync", "Digital noise clock", "Hard sync and noise clock"},
+			[=]() {return module->syncTarget;},
+			[=](size_t target) {
+				module->syncTarget = target;
+				module->rebuildEngines();
+			}
+		));
+		menu->addChild(createBoolPtrMenuItem("Quantizer only", "", &module->quantizerOnly));
+		menu->addChild(createIndexSubmenuItem("Resampling quality", {"Draft", "Normal", "High"},
+			[=]() {return module->srcQuality;},
+			[=](size_t quality) {
+				module->srcQuality = quality;
+				module->rebuildEngines();
+			}
+		));
+
+		std::string tuningName = "Braids scales";
+		if (!module->scalaPath.empty()) {
+			tuningName = system::getFilename(module->scalaPath);
+			if (!module->kbmPath.empty())
+				tuningName += ", " + system::getFilename(module->kbmPath);
+			if (!module->scalaLoaded)
+				tuningName += " (not loaded)";
+		}
+		menu->addChild(createSubmenuItem("Tuning", tuningName, [=](Menu* menu) {
+			menu->addChild(createMenuItem("Load Scala scale...", "", [=]() {
+				osdialog_filters* filters = osdialog_filters_parse("Scala scale:scl");
+				char* pathC = osdialog_file(OSDIALOG_OPEN, NULL, NULL, filters);
+				osdialog_filters_free(filters);
+				if (!pathC)
+					return;
+				std::string path = pathC;
+				std::free(pathC);
+				module->loadScala(path, module->kbmPath);
+			}));
+			menu->addChild(createMenuItem("Load keyboard mapping...", "", [=]() {
+				osdialog_filters* filters = osdialog_filters_parse("Scala keyboard mapping:kbm");
+				char* pathC = osdialog_file(OSDIALOG_OPEN, NULL, NULL, filters);
+				osdialog_filters_free(filters);
+				if (!pathC)
+					return;
+				std::string path = pathC;
+				std::free(pathC);
+				module->loadScala(module->scalaPath, path);
+			}));
+			menu->addChild(createCheckMenuItem("Default keyboard mapping", "",
+				[=]() {return module->kbmPath.empty();},
+				[=]() {module->loadScala(module->scalaPath, "");}
+			));
+			menu->addChild(createCheckMenuItem("Braids scales", "",
+				[=]() {return module->scalaPath.empty();},
+				[=]() {module->loadScala("", module->kbmPath);}
+			));
+		}));
+
+		std::string wavetableName = "Braids";
+		if (!module->wavetablePath.empty()) {
+			wavetableName = system::getFilename(module->wavetablePath);
+			if (!module->wavetableLoaded)
+				wavetableName += " (not loaded)";
+		}
+		menu->addChild(createSubmenuItem("Wavetable", wavetableName, [=](Menu* menu) {
+			menu->addChild(createMenuItem("Load WAV...", "", [=]() {
+				osdialog_filters* filters = osdialog_filters_parse("WAV:wav");
+				char* pathC = osdialog_file(OSDIALOG_OPEN, NULL, NULL, filters);
+				osdialog_filters_free(filters);
+				if (!pathC)
+					return;
+				std::string path = pathC;
+				std::free(pathC);
+				module->loadWavetable(path);
+			}));
+			menu->addChild(createCheckMenuItem("Braids tables", "",
+				[=]() {return module->wavetablePath.empty();},
+				[=]() {module->loadWavetable("");}
+			));
+		}));
+
+		appendControlRateMenu(menu, module);
+	}
 };
 
 
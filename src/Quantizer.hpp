@@ -0,0 +1,115 @@
+/*
+ * This file is part of VectorModular.
+ *
+ * VectorModular is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * VectorModular is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#pragma once
+#include "plugin.hpp"
+#include "braids/quantizer.h"
+
+
+//quantizer lookup in braids pitch units (128 per semitone). built from a braids scale and root, or from any sorted
+//list of pitches (scala tunings). quantizing a voice is a table read plus a hysteresis check
+struct QuantizerTable {
+	static const int CODEBOOK_SIZE = 1024;
+	static const int BRAIDS_CODEBOOK_SIZE = 128;
+	static const int PITCH_RANGE = 16384;
+
+	int size = 0;
+	int32_t codebook[CODEBOOK_SIZE] = {}; //notes, ascending
+	int32_t lowerBoundary[CODEBOOK_SIZE] = {}; //a voice keeps its note while the pitch stays inside these
+	int32_t upperBoundary[CODEBOOK_SIZE] = {};
+	uint16_t nearest[PITCH_RANGE] = {}; //closest codebook entry for every pitch
+	bool activeNotes[12] = {}; //notes of the scale, for the keyboard leds
+	int32_t span = 1536; //the notes repeat every span
+
+	//same codebook layout as braids::Quantizer::Configure, 64 notes up and 64 down from the root
+	void build(const braids::Scale& scale, int32_t root) {
+		span = scale.span;
+		size = BRAIDS_CODEBOOK_SIZE;
+
+		int octave = 0;
+		size_t note = 0;
+		for (int i = 0; i < size / 2; i++) {
+			int32_t up = scale.notes[note] + scale.span * octave;
+			int32_t down = scale.notes[scale.num_notes - 1 - note] + (-octave - 1) * scale.span;
+			codebook[size / 2 + i] = clamp(up, -32768, 32767) + root;
+			codebook[size / 2 - 1 - i] = clamp(down, -32768, 32767) + root;
+			if (++note >= scale.num_notes) {
+				note = 0;
+				octave++;
+			}
+		}
+
+		//braids never picks the outermost entries, so neither do we
+		buildLookup(1, size - 2);
+
+		int rootIndex = (root / 128) % 12;
+		std::fill(activeNotes, activeNotes + 12, false);
+		for (size_t i = 0; i < scale.num_notes; i++) {
+			activeNotes[((scale.notes[i] / 128) + rootIndex) % 12] = true;
+		}
+	}
+
+	//pitches have to be sorted and cover 0 to PITCH_RANGE, with one note past each end so the edges quantize right.
+	//the leds show the semitones closest to the notes of the span above middle c
+	void build(const int32_t* pitches, int count, int32_t pitchSpan) {
+		span = std::max(pitchSpan, 1);
+		size = std::min(count, (int) CODEBOOK_SIZE);
+		std::copy(pitches, pitches + size, codebook);
+
+		buildLookup(0, size - 1);
+
+		std::fill(activeNotes, activeNotes + 12, false);
+		for (int q = 0; q < size; q++) {
+			if (codebook[q] >= 60 * 128 && codebook[q] < 60 * 128 + span) {
+				activeNotes[((codebook[q] + 64) / 128) % 12] = true;
+			}
+		}
+	}
+
+	//hysteresis cells and the nearest note for every pitch, picking only from first to last
+	void buildLookup(int first, int last) {
+
+		//the cell of each note reaches 1/16 of the gap past the midpoint on both sides, like braids does
+		for (int q = 0; q < size; q++) {
+			lowerBoundary[q] = q > 0 ? (9 * codebook[q - 1] + 7 * codebook[q]) >> 4 : INT32_MIN;
+			upperBoundary[q] = q < size - 1 ? (9 * codebook[q + 1] + 7 * codebook[q]) >> 4 : INT32_MAX;
+		}
+
+		//one sweep, the codebook is sorted. ties go to the lower note
+		int q = first;
+		for (int32_t pitch = 0; pitch < PITCH_RANGE; pitch++) {
+			while (q < last && std::abs(codebook[q + 1] - pitch) < std::abs(codebook[q] - pitch)) {
+				q++;
+			}
+			nearest[pitch] = q;
+		}
+	}
+
+	//codeword is the state of one voice, -1 when it has no note yet. pitches below the table (lfo mode reaches -10V)
+	//are folded up by whole spans and moved back down afterwards
+	int32_t process(int32_t pitch, int& codeword) const {
+		int32_t fold = 0;
+		if (pitch < 0) {
+			int32_t spans = (-pitch + span - 1) / span;
+			pitch += spans * span;
+			fold = spans * span;
+		}
+		pitch = std::min(pitch, PITCH_RANGE - 1);
+		if (codeword < 0 || pitch < lowerBoundary[codeword] || pitch > upperBoundary[codeword]) {
+			codeword = nearest[pitch];
+		}
+		return codebook[codeword] - fold;
+	}
+};
@@ -0,0 +1,320 @@
+/*
+ * This file is part of VectorModular.
+ *
+ * VectorModular is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * VectorModular is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include "Scala.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <vector>
+
+
+//lines of a scala file without the comments. blank lines are kept, the description of a scale may be empty
+static bool readLines(const std::string& path, std::vector<std::string>& lines, std::string& error) {
+
+	std::vector<uint8_t> data;
+	try {
+		data = system::readFile(path);
+	} catch (std::exception& e) {
+		error = e.what();
+		return false;
+	}
+
+	std::string line;
+	for (size_t i = 0; i <= data.size(); i++) {
+		if (i == data.size() || data[i] == '\n') {
+			if (!line.empty() && line[line.size() - 1] == '\r') {
+				line.erase(line.size() - 1);
+			}
+			if (line.empty() || line[0] != '!') {
+				lines.push_back(line);
+			}
+			line.clear();
+		} else {
+			line += (char) data[i];
+		}
+	}
+	return true;
+}
+
+//first word of a line, anything after it is a comment
+static std::string firstWord(const std::string& line) {
+	size_t start = line.find_first_not_of(" \t");
+	if (start == std::string::npos) {
+		return "";
+	}
+	size_t end = line.find_first_of(" \t", start);
+	return line.substr(start, end == std::string::npos ? std::string::npos : end - start);
+}
+
+static bool parseInt(const std::string& word, long& value) {
+	char* end;
+	value = std::strtol(word.c_str(), &end, 10);
+	return !word.empty() && *end == '\0';
+}
+
+static bool parseDouble(const std::string& word, double& value) {
+	char* end;
+	value = std::strtod(word.c_str(), &end);
+	return !word.empty() && *end == '\0';
+}
+
+//a pitch with a period is in cents, anything else is a ratio like 3/2 or a whole number like 2
+static bool parsePitch(const std::string& word, double& cents) {
+	if (word.find('.') != std::string::npos) {
+		return parseDouble(word, cents);
+	}
+
+	size_t slash = word.find('/');
+	long num, den = 1;
+	if (!parseInt(word.substr(0, slash), num)) {
+		return false;
+	}
+	if (slash != std::string::npos && !parseInt(word.substr(slash + 1), den)) {
+		return false;
+	}
+	if (num <= 0 || den <= 0) {
+		return false;
+	}
+	cents = 1200.0 * std::log2((double) num / den);
+	return true;
+}
+
+//degree 0 is the 1/1, the last degree of the file is the period the scale repeats at
+static bool parseScl(const std::vector<std::string>& lines, ScalaTuning& tuning, std::vector<double>& degrees, std::string& error) {
+
+	//the description is the first line, the rest skips blanks
+	std::vector<std::string> words;
+	for (size_t i = 1; i < lines.size(); i++) {
+		std::string word = firstWord(lines[i]);
+		if (!word.empty()) {
+			words.push_back(word);
+		}
+	}
+
+	long numNotes;
+	if (lines.empty() || words.empty() || !parseInt(words[0], numNotes) || numNotes < 1) {
+		error = "not a scala scale file";
+		return false;
+	}
+	if ((long) words.size() - 1 < numNotes) {
+		error = "scale has fewer notes than it says";
+		return false;
+	}
+
+	tuning.description = lines[0];
+	tuning.numNotes = numNotes;
+
+	degrees.assign(1, 0.0);
+	for (long i = 1; i <= numNotes; i++) {
+		double cents;
+		if (!parsePitch(words[i], cents)) {
+			error = "can't read pitch " + words[i];
+			return false;
+		}
+		degrees.push_back(cents);
+	}
+
+	if (degrees.back() <= 0.0) {
+		error = "scale has to end above its 1/1";
+		return false;
+	}
+	return true;
+}
+
+struct KeyboardMapping {
+	long size = 0; //0 maps every key to the next degree
+	long middleNote = 60; //key of degree 0
+	long referenceNote = 60;
+	double referenceFrequency = dsp::FREQ_C4;
+	long octaveDegree = 0; //degree the mapping repeats at, 0 for the period of the scale
+	std::vector<long> degrees; //-1 for keys that are not mapped
+};
+
+static bool parseKbm(const std::vector<std::string>& lines, KeyboardMapping& mapping, std::string& error) {
+
+	std::vector<std::string> words;
+	for (size_t i = 0; i < lines.size(); i++) {
+		std::string word = firstWord(lines[i]);
+		if (!word.empty()) {
+			words.push_back(word);
+		}
+	}
+
+	//the first and last key to retune are skipped, the whole pitch range is tuned
+	long firstNote, lastNote;
+	if (words.size() < 7 || !parseInt(words[0], mapping.size) || !parseInt(words[1], firstNote) || !parseInt(words[2], lastNote)
+			|| !parseInt(words[3], mapping.middleNote) || !parseInt(words[4], mapping.referenceNote)
+			|| !parseDouble(words[5], mapping.referenceFrequency) || !parseInt(words[6], mapping.octaveDegree)
+			|| mapping.size < 0 || mapping.referenceFrequency <= 0.0) {
+		error = "not a scala keyboard mapping file";
+		return false;
+	}
+
+	//keys missing at the end of the mapping are not mapped
+	for (long i = 0; i < mapping.size; i++) {
+		long degree = -1;
+		if (7 + i < (long) words.size() && words[7 + i] != "x" && (!parseInt(words[7 + i], degree) || degree < 0)) {
+			error = "can't read mapping entry " + words[7 + i];
+			return false;
+		}
+		mapping.degrees.push_back(degree);
+	}
+	return true;
+}
+
+static long floorDiv(long a, long b) {
+	return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+static double degreeCents(const std::vector<double>& degrees, long degree) {
+	long notes = degrees.size() - 1;
+	long octave = floorDiv(degree, notes);
+	return octave * degrees.back() + degrees[degree - octave * notes];
+}
+
+//cents of a key above the 1/1 of the scale, false when the key is not mapped
+static bool keyCents(const std::vector<double>& degrees, const KeyboardMapping& mapping, long key, double& cents) {
+	long offset = key - mapping.middleNote;
+	if (mapping.size == 0) {
+		cents = degreeCents(degrees, offset);
+		return true;
+	}
+
+	long octave = floorDiv(offset, mapping.size);
+	long degree = mapping.degrees[offset - octave * mapping.size];
+	if (degree < 0) {
+		return false;
+	}
+	double octaveCents = mapping.octaveDegree > 0 ? degreeCents(degrees, mapping.octaveDegree) : degrees.back();
+	cents = octave * octaveCents + degreeCents(degrees, degree);
+	return true;
+}
+
+//every mapped key that lands in the braids pitch range, plus one on each side
+static bool buildTable(ScalaTuning& tuning, const std::vector<double>& degrees, const KeyboardMapping& mapping, std::string& error) {
+
+	const int range = QuantizerTable::PITCH_RANGE;
+
+	double octaveCents = mapping.size > 0 && mapping.octaveDegree > 0 ? degreeCents(degrees, mapping.octaveDegree) : degrees.back();
+	double referenceCents;
+	if (octaveCents <= 0.0) {
+		error = "mapping has to repeat above its first key";
+		return false;
+	}
+	if (!keyCents(degrees, mapping, mapping.referenceNote, referenceCents)) {
+		error = "reference key is not mapped";
+		return false;
+	}
+
+	//braids pitch is 128 per semitone with 0 on midi note 0
+	double referencePitch = 128.0 * (69.0 + 12.0 * std::log2(mapping.referenceFrequency / 440.0));
+	double span = octaveCents * 128.0 / 100.0;
+	long keysPerSpan = mapping.size > 0 ? mapping.size : tuning.numNotes;
+
+	//enough whole spans either side of the middle key to get past both ends of the range
+	double middleCents = 0.0;
+	keyCents(degrees, mapping, mapping.middleNote, middleCents);
+	double middlePitch = referencePitch + (middleCents - referenceCents) * 128.0 / 100.0;
+	long spansDown = (long) std::ceil(std::max(middlePitch, 0.0) / span) + 2;
+	long spansUp = (long) std::ceil(std::max(range - middlePitch, 0.0) / span) + 2;
+	if ((spansDown + spansUp) * keysPerSpan > 1000000) {
+		error = "scale is too dense";
+		return false;
+	}
+
+	std::vector<int32_t> pitches;
+	for (long key = mapping.middleNote - spansDown * keysPerSpan; key < mapping.middleNote + spansUp * keysPerSpan; key++) {
+		double cents;
+		if (keyCents(degrees, mapping, key, cents)) {
+			pitches.push_back((int32_t) std::round(referencePitch + (cents - referenceCents) * 128.0 / 100.0));
+		}
+	}
+
+	//the degrees of a scale don't have to be in order
+	std::sort(pitches.begin(), pitches.end());
+	pitches.erase(std::unique(pitches.begin(), pitches.end()), pitches.end());
+	if (pitches.empty()) {
+		error = "mapping has no keys";
+		return false;
+	}
+
+	int first = std::lower_bound(pitches.begin(), pitches.end(), 0) - pitches.begin();
+	int last = std::upper_bound(pitches.begin(), pitches.end(), range - 1) - pitches.begin();
+	first = std::max(first - 1, 0);
+	last = std::min(last, (int) pitches.size() - 1);
+
+	//very dense tunings don't fit the table. they keep the notes around middle c and the outer ones clamp
+	if (last - first + 1 > QuantizerTable::CODEBOOK_SIZE) {
+		int middle = std::lower_bound(pitches.begin(), pitches.end(), 60 * 128) - pitches.begin();
+		first = clamp(middle - QuantizerTable::CODEBOOK_SIZE / 2, first, last + 1 - QuantizerTable::CODEBOOK_SIZE);
+		last = first + QuantizerTable::CODEBOOK_SIZE - 1;
+	}
+
+	tuning.table.build(&pitches[first], last - first + 1, (int32_t) std::round(span));
+	return true;
+}
+
+
+//tunings stay in memory for as long as a module uses them
+static std::mutex cacheMutex;
+static std::map<std::string, std::weak_ptr<const ScalaTuning>> cache;
+
+std::shared_ptr<const ScalaTuning> loadScalaTuning(const std::string& sclPath, const std::string& kbmPath, std::string& error) {
+
+	std::string key = sclPath + "\n" + kbmPath;
+	{
+		std::lock_guard<std::mutex> lock(cacheMutex);
+		auto it = cache.find(key);
+		if (it != cache.end()) {
+			std::shared_ptr<const ScalaTuning> cached = it->second.lock();
+			if (cached) {
+				return cached;
+			}
+		}
+	}
+
+	std::shared_ptr<ScalaTuning> tuning = std::make_shared<ScalaTuning>();
+	tuning->sclPath = sclPath;
+	tuning->kbmPath = kbmPath;
+
+	std::vector<std::string> lines;
+	std::vector<double> degrees;
+	if (!readLines(sclPath, lines, error) || !parseScl(lines, *tuning, degrees, error)) {
+		return NULL;
+	}
+
+	KeyboardMapping mapping;
+	lines.clear();
+	if (!kbmPath.empty() && (!readLines(kbmPath, lines, error) || !parseKbm(lines, mapping, error))) {
+		return NULL;
+	}
+
+	if (!buildTable(*tuning, degrees, mapping, error)) {
+		return NULL;
+	}
+
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	//entries of tunings no module uses any more are dropped here, so loading file after file doesn't grow the map
+	for (auto it = cache.begin(); it != cache.end();) {
+		if (it->second.expired())
+			it = cache.erase(it);
+		else
+			++it;
+	}
+	cache[key] = tuning;
+	return tuning;
+}
@@ -0,0 +1,35 @@
+/*
+ * This file is part of VectorModular.
+ *
+ * VectorModular is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * VectorModular is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#pragma once
+#include "plugin.hpp"
+#include "Quantizer.hpp"
+#include <memory>
+#include <string>
+
+
+//microtuning from a scala scale (.scl) and keyboard mapping (.kbm), compiled into a quantizer table that covers the
+//whole pitch range. read-only once built and shared by every module that loads the same files
+struct ScalaTuning {
+	std::string sclPath;
+	std::string kbmPath; //empty for the default mapping, the 1/1 of the scale on middle c
+	std::string description;
+	int numNotes = 0;
+	QuantizerTable table; //untransposed, the module moves it by the root knob
+};
+
+//loads a tuning, or hands out the one already in memory for these files. reads the files, call it off the audio
+//thread. returns NULL and fills in error when a file can't be used
+std::shared_ptr<const ScalaTuning> loadScalaTuning(const std::string& sclPath, const std::string& kbmPath, std::string& error);
@@ -21,7 +21,7 @@
 //declare maxChGainKnobValue
 float maxChGainKnobValue = std::sqrt(1.5);
 
-struct SoloMixer : Module {
+struct SoloMixer : ControlRateModule {
 	enum ParamId {
 		SOLORED_PARAM,
 		LEVELRED_PARAM,
@@ -185,7 +185,7 @@ struct SoloMixer : Module {
 	//json input and output.
 
 	json_t* dataToJson() override {
-    json_t* rootJ = json_object();
+    json_t* rootJ = ControlRateModule::dataToJson();
     
     // Save solo statuses
     json_object_set_new(rootJ, "redSoloF", json_boolean(redSoloF));
@@ -200,6 +200,8 @@ struct SoloMixer : Module {
 }
 
 void dataFromJson(json_t* rootJ) override {
+    ControlRateModule::dataFromJson(rootJ);
+
     json_t* redSoloFJ = json_object_get(rootJ, "redSoloF");
     if (redSoloFJ)
         redSoloF = json_is_true(redSoloFJ);
@@ -231,28 +233,8 @@ void dataFromJson(json_t* rootJ) override {
 
 }
 	
-	void process(const ProcessArgs& args) override {
-
-		//cascading inputs and also CV offset default.
-		redSignal = inputs[RED_INPUT].isConnected() ? inputs[RED_INPUT].getVoltage() : 5.0f;
-		greenSignal = inputs[GREEN_INPUT].isConnected() ? inputs[GREEN_INPUT].getVoltage() : redSignal;
-		blueSignal = inputs[BLUE_INPUT].isConnected() ? inputs[BLUE_INPUT].getVoltage() : greenSignal;
-
-		// Apply attenuation/gain using std::pow.
-    	redSignal *= std::pow(params[LEVELRED_PARAM].getValue(), 2);
-		//apply soft clip
-		redSignal = softClip(redSignal,rgbThresholdClip);
-		//apply clamp 
-		redSignal = clamp(redSignal, -10.0f, 10.0f);
-
-    	greenSignal *= std::pow(params[LEVELGREEN_PARAM].getValue(), 2);
-		greenSignal = softClip(greenSignal,rgbThresholdClip);
-		greenSignal = clamp(greenSignal, -10.0f, 10.0f);
-
-    	blueSignal *= std::pow(params[LEVELBLUE_PARAM].getValue(), 2);
-		blueSignal = softClip(blueSignal,rgbThresholdClip);
-		blueSignal = clamp(blueSignal, -10.0f, 10.0f); 
-
+	//solo buttons, called at the control rate. a return here only skips the remaining buttons
+	void processSoloButtons(){
 
 		//one day, go back and make this toggle button logic a function to clean all of this redundancy up
 		
@@ -321,71 +303,106 @@ void dataFromJson(json_t* rootJ) override {
 		} else{
 			soloToggleButtonLastState = false;
 		}
+	}
 
-	//color output led logic
+	void process(const ProcessArgs& args) override {
 
-	// Smooth LED brightness calculations
-		auto signalToLEDBrightness = [&](float voltage, float& buffer) {
-			float targetBrightness;
+		//cascading inputs and also CV offset default.
+		redSignal = inputs[RED_INPUT].isConnected() ? inputs[RED_INPUT].getVoltage() : 5.0f;
+		greenSignal = inputs[GREEN_INPUT].isConnected() ? inputs[GREEN_INPUT].getVoltage() : redSignal;
+		blueSignal = inputs[BLUE_INPUT].isConnected() ? inputs[BLUE_INPUT].getVoltage() : greenSignal;
 
-			voltage = std::abs(voltage);
+		// Apply attenuation/gain using std::pow.
+    	redSignal *= std::pow(params[LEVELRED_PARAM].getValue(), 2);
+		//apply soft clip
+		redSignal = softClip(redSignal,rgbThresholdClip);
+		//apply clamp 
+		redSignal = clamp(redSignal, -10.0f, 10.0f);
 
-			if (voltage >= 5.0f) {
-				targetBrightness = 1.0f; // Full brightness for voltages >= 5V
-			} else if (voltage > 0.0f && voltage < 5.0f) {
-				targetBrightness = voltage / 5.0f; // Interpolate
-			} else {
-				targetBrightness = 0.0f; // Off for voltages >= 0V
-			}
+    	greenSignal *= std::pow(params[LEVELGREEN_PARAM].getValue(), 2);
+		greenSignal = softClip(greenSignal,rgbThresholdClip);
+		greenSignal = clamp(greenSignal, -10.0f, 10.0f);
+
+    	blueSignal *= std::pow(params[LEVELBLUE_PARAM].getValue(), 2);
+		blueSignal = softClip(blueSignal,rgbThresholdClip);
+		blueSignal = clamp(blueSignal, -10.0f, 10.0f); 
+
+
+		//buttons and lights run at the control rate
+		bool controlTick = processControlRate();
+
+		if(controlTick){
+
+			processSoloButtons();
 
-			// Adjusted for more responsive smoothing
-			buffer += (targetBrightness - buffer) * 0.001f; // Factor for responsiveness. maye need to play with this if it doesn't look right
-			return buffer;
-		};
+		//color output led logic
 
+		// Smooth LED brightness calculations
+			float smoothing = getControlSmoothing(0.001f);
 
-		chRledBrightness = signalToLEDBrightness(redSignal,redLEDBuffer);
-		chRledMixBrightness = chRledBrightness;
+			auto signalToLEDBrightness = [&](float voltage, float& buffer) {
+				float targetBrightness;
+
+				voltage = std::abs(voltage);
+
+				if (voltage >= 5.0f) {
+					targetBrightness = 1.0f; // Full brightness for voltages >= 5V
+				} else if (voltage > 0.0f && voltage < 5.0f) {
+					targetBrightness = voltage / 5.0f; // Interpolate
+				} else {
+					targetBrightness = 0.0f; // Off for voltages >= 0V
+				}
+
+				// Adjusted for more responsive smoothing
+				buffer += (targetBrightness - buffer) * smoothing; // Factor for responsiveness. maye need to play with this if it doesn't look right
+				return buffer;
+			};
+
+
+			chRledBrightness = signalToLEDBrightness(redSignal,redLEDBuffer);
+			chRledMixBrightness = chRledBrightness;
 		
-		chGledBrightness = signalToLEDBrightness(greenSignal,greenLEDBuffer);
-		chGledMixBrightness = chGledBrightness;
+			chGledBrightness = signalToLEDBrightness(greenSignal,greenLEDBuffer);
+			chGledMixBrightness = chGledBrightness;
 
-		chBledBrightness = signalToLEDBrightness(blueSignal,blueLEDBuffer);
-		chBledMixBrightness = chBledBrightness;		
+			chBledBrightness = signalToLEDBrightness(blueSignal,blueLEDBuffer);
+			chBledMixBrightness = chBledBrightness;		
 
-		lights[CHrLED_RGB + 0].setBrightness(chRledBrightness); // red brightness
-		lights[CHrLED_RGB + 1].setBrightness(0.f); // green brightness
-		lights[CHrLED_RGB + 2].setBrightness(0.); // blue brightness 
+			lights[CHrLED_RGB + 0].setBrightness(chRledBrightness); // red brightness
+			lights[CHrLED_RGB + 1].setBrightness(0.f); // green brightness
+			lights[CHrLED_RGB + 2].setBrightness(0.); // blue brightness 
 
-		lights[CHgLED_RGB + 0].setBrightness(0.f); 
-		lights[CHgLED_RGB + 1].setBrightness(chGledBrightness); 
-		lights[CHgLED_RGB + 2].setBrightness(0.f);
+			lights[CHgLED_RGB + 0].setBrightness(0.f); 
+			lights[CHgLED_RGB + 1].setBrightness(chGledBrightness); 
+			lights[CHgLED_RGB + 2].setBrightness(0.f);
 
-		lights[CHbLED_RGB + 0].setBrightness(0.f); 
-		lights[CHbLED_RGB + 1].setBrightness(0.f); 
-		lights[CHbLED_RGB + 2].setBrightness(chBledBrightness);
+			lights[CHbLED_RGB + 0].setBrightness(0.f); 
+			lights[CHbLED_RGB + 1].setBrightness(0.f); 
+			lights[CHbLED_RGB + 2].setBrightness(chBledBrightness);
 		
 		
-		//solo LED logic
-
-		if(soloToggle){	
-			lights[ToggleTled1].setBrightness(1.0f);
-			lights[ToggleTled2].setBrightness(1.0f);
-			lights[ToggleFled].setBrightness(0.f);
-		}else{
-			lights[ToggleTled1].setBrightness(0.f);
-			lights[ToggleTled2].setBrightness(0.f);
-			lights[ToggleFled].setBrightness(1.0f);
-		}
+			//solo LED logic
 
-		soloTLedStatus(redSoloT,RsoloTled1,RsoloTled2);
-		soloFLedStatus(redSoloF,RsoloFled);
+			if(soloToggle){	
+				lights[ToggleTled1].setBrightness(1.0f);
+				lights[ToggleTled2].setBrightness(1.0f);
+				lights[ToggleFled].setBrightness(0.f);
+			}else{
+				lights[ToggleTled1].setBrightness(0.f);
+				lights[ToggleTled2].setBrightness(0.f);
+				lights[ToggleFled].setBrightness(1.0f);
+			}
+
+			soloTLedStatus(redSoloT,RsoloTled1,RsoloTled2);
+			soloFLedStatus(redSoloF,RsoloFled);
 
-		soloTLedStatus(greenSoloT,GsoloTled1,GsoloTled2);
-		soloFLedStatus(greenSoloF,GsoloFled);
+			soloTLedStatus(greenSoloT,GsoloTled1,GsoloTled2);
+			soloFLedStatus(greenSoloF,GsoloFled);
 
-		soloTLedStatus(blueSoloT,BsoloTled1,BsoloTled2);
-		soloFLedStatus(blueSoloF,BsoloFled);
+			soloTLedStatus(blueSoloT,BsoloTled1,BsoloTled2);
+			soloFLedStatus(blueSoloF,BsoloFled);
+
+		} //end of control rate buttons and lights
 		
 		
 		//figure out which channels should be muted, and also the final led output
@@ -441,10 +458,11 @@ void dataFromJson(json_t* rootJ) override {
 		uMixSignal = clamp(uMixSignal, -10.0f, 10.0f); //i think this being set to zero was messing up the output. maybe relabel + to Uni or something
 		
 		//mix color based on solos
-		
-		lights[CHmLED_RGB + 0].setBrightness(chRledMixBrightness); 
-		lights[CHmLED_RGB + 1].setBrightness(chGledMixBrightness); 
-		lights[CHmLED_RGB + 2].setBrightness(chBledMixBrightness);
+		if(controlTick){
+			lights[CHmLED_RGB + 0].setBrightness(chRledMixBrightness); 
+			lights[CHmLED_RGB + 1].setBrightness(chGledMixBrightness); 
+			lights[CHmLED_RGB + 2].setBrightness(chBledMixBrightness);
+		}
 
 		//set outputs
 		outputs[RED_OUTPUT].setVoltage(redSignal);
@@ -507,6 +525,10 @@ struct SoloMixerWidget : ModuleWidget {
 		addChild(createLightCentered<TinyLight<YellowLight>>(mm2px(Vec(3.309,65.6335)), module, SoloMixer::BsoloTled1));
 		addChild(createLightCentered<TinyLight<YellowLight>>(mm2px(Vec(6.034,65.6335)), module, SoloMixer::BsoloTled2));
 	}
+
+	void appendContextMenu(Menu* menu) override {
+		appendControlRateMenu(menu, getModule<SoloMixer>());
+	}
 };
 
 
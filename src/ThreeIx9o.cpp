@@ -27,7 +27,7 @@ float mapVoltageToBrightness(float voltage, float minVoltage, float maxVoltage)
     return brightness;
 }
 
-struct ThreeIx9o : Module {
+struct ThreeIx9o : ControlRateModule {
 	enum ParamId {
 		PARAMS_LEN
 	};
@@ -96,6 +96,13 @@ struct ThreeIx9o : Module {
 		outputs[OUTPUT8_OUTPUT].setVoltage(input3);
 		outputs[OUTPUT9_OUTPUT].setVoltage(input3);
 
+		// LEDs only update at the control rate
+		if (!processControlRate()) {
+			return;
+		}
+
+		float smoothing = getControlSmoothing(0.2f);
+
 		// Smooth LED brightness calculations
 		auto mapToRed = [&](float voltage, float& buffer) {
 			float targetBrightness;
@@ -108,7 +115,7 @@ struct ThreeIx9o : Module {
 			}
 
 			// Adjusted for more responsive smoothing
-			buffer += (targetBrightness - buffer) * 0.2f; // Factor for responsiveness
+			buffer += (targetBrightness - buffer) * smoothing; // Factor for responsiveness
 			return buffer;
 		};
 
@@ -123,7 +130,7 @@ struct ThreeIx9o : Module {
 			}
 
 			// Adjusted for more responsive smoothing
-			buffer += (targetBrightness - buffer) * 0.2f; // Factor for responsiveness
+			buffer += (targetBrightness - buffer) * smoothing; // Factor for responsiveness
 			return buffer;
 		};
 
@@ -178,6 +185,10 @@ struct ThreeIx9oWidget : ModuleWidget {
 		addChild(createLightCentered<MediumLight<RedGreenBlueLight>>(mm2px(Vec(14.687, 54.114)), module, ThreeIx9o::LED2_RGB));
 		addChild(createLightCentered<MediumLight<RedGreenBlueLight>>(mm2px(Vec(14.687, 91.322)), module, ThreeIx9o::LED3_RGB));
 	}
+
+	void appendContextMenu(Menu* menu) override {
+		appendControlRateMenu(menu, getModule<ThreeIx9o>());
+	}
 };
 
 Model* modelThreeIx9o = createModel<ThreeIx9o, ThreeIx9oWidget>("ThreeIx9o");
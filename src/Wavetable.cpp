@@ -0,0 +1,276 @@
+/*
+ * This file is part of VectorModular.
+ *
+ * VectorModular is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * VectorModular is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include "Wavetable.hpp"
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <vector>
+#include <pffft.h>
+
+
+UserWavetable::~UserWavetable() {
+	if (storage) {
+		pffft_aligned_free(storage);
+	}
+}
+
+
+static uint32_t readLE(const uint8_t* p, int bytes) {
+	uint32_t value = 0;
+	for (int i = 0; i < bytes; i++) {
+		value |= (uint32_t) p[i] << (8 * i);
+	}
+	return value;
+}
+
+//first channel of a pcm or float wav, as floats. cycleSize is filled in when the file says how long its cycles are
+static bool parseWav(const std::vector<uint8_t>& data, std::vector<float>& samples, int& cycleSize, std::string& error) {
+
+	if (data.size() < 12 || std::memcmp(&data[0], "RIFF", 4) != 0 || std::memcmp(&data[8], "WAVE", 4) != 0) {
+		error = "not a wav file";
+		return false;
+	}
+
+	int format = 0;
+	int numChannels = 0;
+	int bitsPerSample = 0;
+	const uint8_t* sampleData = NULL;
+	size_t sampleBytes = 0;
+
+	//walk the chunks. anything we don't know is skipped
+	size_t pos = 12;
+	while (pos + 8 <= data.size()) {
+		const uint8_t* chunk = &data[pos];
+		size_t chunkSize = readLE(chunk + 4, 4);
+		size_t available = std::min(chunkSize, data.size() - pos - 8);
+
+		if (std::memcmp(chunk, "fmt ", 4) == 0 && available >= 16) {
+			format = readLE(chunk + 8, 2);
+			numChannels = readLE(chunk + 10, 2);
+			bitsPerSample = readLE(chunk + 22, 2);
+			//extensible format keeps the real one in the first bytes of the sub format guid
+			if (format == 0xFFFE && available >= 26) {
+				format = readLE(chunk + 32, 2);
+			}
+		} else if (std::memcmp(chunk, "data", 4) == 0) {
+			sampleData = chunk + 8;
+			sampleBytes = available;
+		} else if (std::memcmp(chunk, "clm ", 4) == 0 && available > 3 && std::memcmp(chunk + 8, "<!>", 3) == 0) {
+			//serum style wavetables write their cycle length here
+			std::string text((const char*) chunk + 11, available - 3);
+			cycleSize = std::atoi(text.c_str());
+		}
+
+		pos += 8 + chunkSize + (chunkSize & 1); //chunks are padded to an even size
+	}
+
+	if (!sampleData || numChannels < 1) {
+		error = "no audio data";
+		return false;
+	}
+
+	bool isFloat = format == 3 && bitsPerSample == 32;
+	bool isPCM = format == 1 && (bitsPerSample == 8 || bitsPerSample == 16 || bitsPerSample == 24 || bitsPerSample == 32);
+	if (!isFloat && !isPCM) {
+		error = "unsupported sample format, use 8/16/24/32 bit pcm or 32 bit float";
+		return false;
+	}
+
+	int bytesPerSample = bitsPerSample / 8;
+	size_t frameBytes = bytesPerSample * numChannels;
+	size_t numFrames = sampleBytes / frameBytes;
+	samples.resize(numFrames);
+
+	for (size_t i = 0; i < numFrames; i++) {
+		const uint8_t* p = sampleData + i * frameBytes;
+		uint32_t raw = readLE(p, bytesPerSample);
+		if (isFloat) {
+			float value;
+			std::memcpy(&value, &raw, sizeof(value));
+			samples[i] = value;
+		} else if (bitsPerSample == 8) {
+			samples[i] = ((int) raw - 128) / 128.f; //8 bit wav is unsigned
+		} else {
+			//shift the sample to the top of an int32 so the sign comes along
+			int32_t value = (int32_t) (raw << (32 - bitsPerSample));
+			samples[i] = value / 2147483648.f;
+		}
+	}
+	return true;
+}
+
+static bool buildWavetable(UserWavetable& table, const std::vector<float>& samples, int cycleSize, std::string& error) {
+
+	const int N = UserWavetable::WAVE_SIZE;
+
+	//without a length in the file, go with the common 2048 sample cycles, then 256, then the whole file as one cycle
+	int numFrames = samples.size();
+	if (cycleSize <= 0 || cycleSize > numFrames) {
+		if (numFrames >= N && numFrames % N == 0) {
+			cycleSize = N;
+		} else if (numFrames >= 256 && numFrames % 256 == 0) {
+			cycleSize = 256;
+		} else {
+			cycleSize = numFrames;
+		}
+	}
+
+	if (cycleSize < 2) {
+		error = "file is too short";
+		return false;
+	}
+
+	table.numWaves = std::min(numFrames / cycleSize, (int) UserWavetable::MAX_WAVES);
+
+	//storage for every level, rows padded to 16 floats so they start on a cache line
+	size_t total = 0;
+	for (int m = 0; m < UserWavetable::LEVELS; m++) {
+		table.levelSize[m] = std::max(N >> m, (int) UserWavetable::MIN_LEVEL_SIZE);
+		table.rowStride[m] = (table.levelSize[m] + 1 + 15) & ~15;
+		total += (size_t) table.rowStride[m] * table.numWaves;
+	}
+	table.storage = (float*) pffft_aligned_malloc(total * sizeof(float));
+	if (!table.storage) {
+		error = "out of memory";
+		return false;
+	}
+	float* level = table.storage;
+	for (int m = 0; m < UserWavetable::LEVELS; m++) {
+		table.levelData[m] = level;
+		level += (size_t) table.rowStride[m] * table.numWaves;
+	}
+
+	//fft buffers have to be aligned too
+	float* wave = (float*) pffft_aligned_malloc(N * sizeof(float));
+	float* spectrum = (float*) pffft_aligned_malloc(N * sizeof(float));
+	float* levelSpectrum = (float*) pffft_aligned_malloc(N * sizeof(float));
+	float* levelWave = (float*) pffft_aligned_malloc(N * sizeof(float));
+
+	dsp::RealFFT fft(N);
+	std::map<int, std::shared_ptr<dsp::RealFFT>> levelFFTs;
+	for (int m = 0; m < UserWavetable::LEVELS; m++) {
+		if (!levelFFTs.count(table.levelSize[m])) {
+			levelFFTs[table.levelSize[m]] = std::make_shared<dsp::RealFFT>(table.levelSize[m]);
+		}
+	}
+
+	float peak = 0.f;
+
+	for (int w = 0; w < table.numWaves; w++) {
+
+		//resample the cycle to the table length, wrapping around at the end
+		const float* cycle = &samples[w * cycleSize];
+		for (int i = 0; i < N; i++) {
+			float x = (float) i * cycleSize / N;
+			int x0 = (int) x;
+			int x1 = (x0 + 1) % cycleSize;
+			wave[i] = cycle[x0] + (cycle[x1] - cycle[x0]) * (x - x0);
+		}
+
+		fft.rfft(wave, spectrum);
+
+		//every level keeps the harmonics it can play an octave higher than the one before it without aliasing.
+		//dc goes, so the output stays centered
+		for (int m = 0; m < UserWavetable::LEVELS; m++) {
+			int size = table.levelSize[m];
+			int harmonics = std::min(UserWavetable::harmonics(m), size / 2 - 1);
+
+			std::memset(levelSpectrum, 0, size * sizeof(float));
+			std::memcpy(&levelSpectrum[2], &spectrum[2], 2 * harmonics * sizeof(float));
+			levelFFTs[size]->irfft(levelSpectrum, levelWave);
+
+			float* row = table.levelData[m] + w * table.rowStride[m];
+			for (int i = 0; i < size; i++) {
+				row[i] = levelWave[i] / N;
+			}
+			row[size] = row[0];
+			std::fill(row + size + 1, row + table.rowStride[m], 0.f);
+
+			if (m == 0) {
+				for (int i = 0; i < size; i++) {
+					peak = std::max(peak, std::abs(row[i]));
+				}
+			}
+		}
+	}
+
+	pffft_aligned_free(wave);
+	pffft_aligned_free(spectrum);
+	pffft_aligned_free(levelSpectrum);
+	pffft_aligned_free(levelWave);
+
+	if (peak <= 0.f) {
+		error = "file is silent";
+		return false;
+	}
+
+	//full scale like the braids tables
+	for (size_t i = 0; i < total; i++) {
+		table.storage[i] /= peak;
+	}
+	return true;
+}
+
+
+//tables stay in memory for as long as a module uses them
+static std::mutex cacheMutex;
+static std::map<std::string, std::weak_ptr<const UserWavetable>> cache;
+
+std::shared_ptr<const UserWavetable> loadUserWavetable(const std::string& path, std::string& error) {
+
+	{
+		std::lock_guard<std::mutex> lock(cacheMutex);
+		auto it = cache.find(path);
+		if (it != cache.end()) {
+			std::shared_ptr<const UserWavetable> cached = it->second.lock();
+			if (cached) {
+				return cached;
+			}
+		}
+	}
+
+	std::vector<uint8_t> data;
+	try {
+		data = system::readFile(path);
+	} catch (std::exception& e) {
+		error = e.what();
+		return NULL;
+	}
+
+	std::vector<float> samples;
+	int cycleSize = 0;
+	if (!parseWav(data, samples, cycleSize, error)) {
+		return NULL;
+	}
+
+	std::shared_ptr<UserWavetable> table = std::make_shared<UserWavetable>();
+	table->path = path;
+	if (!buildWavetable(*table, samples, cycleSize, error)) {
+		return NULL;
+	}
+
+	//two modules loading the same file at once both build it, the last one ends up in the cache. harmless
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	//entries of tables no module uses any more are dropped here, so loading file after file doesn't grow the map
+	for (auto it = cache.begin(); it != cache.end();) {
+		if (it->second.expired())
+			it = cache.erase(it);
+		else
+			++it;
+	}
+	cache[path] = table;
+	return table;
+}
@@ -0,0 +1,77 @@
+/*
+ * This file is part of VectorModular.
+ *
+ * VectorModular is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * VectorModular is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#pragma once
+#include "plugin.hpp"
+#include <memory>
+#include <string>
+
+
+//wavetable loaded from a wav file. every wave is stored as octave mip-maps, each level band-limited for one more
+//octave of pitch than the one before, so playback only picks a level and never filters. read-only once built and
+//shared by every module that loads the same file
+struct UserWavetable {
+	static const int WAVE_SIZE = 2048; //every cycle is resampled to this length before the mip-maps are built
+	static const int LEVELS = 10; //level 0 keeps 512 harmonics, every level above halves them
+	static const int MIN_LEVEL_SIZE = 64;
+	static const int MAX_WAVES = 256;
+
+	std::string path;
+	int numWaves = 0;
+
+	//one block per level with the waves one after another. every row has a guard sample so interpolation never wraps,
+	//and is padded to whole cache lines
+	int levelSize[LEVELS] = {};
+	int rowStride[LEVELS] = {};
+	float* levelData[LEVELS] = {};
+	float* storage = NULL;
+
+	UserWavetable() {}
+	UserWavetable(const UserWavetable&) = delete;
+	UserWavetable& operator=(const UserWavetable&) = delete;
+	~UserWavetable();
+
+	static int harmonics(int level) {
+		return std::max(512 >> level, 1);
+	}
+
+	//position 0-1 morphs across the waves, phase 0-1 reads along them
+	float read(int level, float position, float phase) const {
+		const float* row = levelData[level];
+		int size = levelSize[level];
+
+		float x = phase * size;
+		int x0 = std::min((int) x, size - 1);
+		float xf = x - x0;
+
+		if (numWaves < 2) {
+			return row[x0] + (row[x0 + 1] - row[x0]) * xf;
+		}
+
+		float w = position * (numWaves - 1);
+		int w0 = std::min((int) w, numWaves - 2);
+		float wf = w - w0;
+
+		const float* a = row + w0 * rowStride[level];
+		const float* b = a + rowStride[level];
+		float va = a[x0] + (a[x0 + 1] - a[x0]) * xf;
+		float vb = b[x0] + (b[x0 + 1] - b[x0]) * xf;
+		return va + (vb - va) * wf;
+	}
+};
+
+//loads a wavetable, or hands out the one already in memory for that file. slow, call it off the audio thread.
+//returns NULL and fills in error when the file can't be used
+std::shared_ptr<const UserWavetable> loadUserWavetable(const std::string& path, std::string& error);
@@ -16,11 +16,55 @@
 #include "plugin.hpp"
 #include <rack.hpp>
 
-// this version tracks 1/16th steps as the basis for the rest of the outputs. trying to minimize drift.
-// triplets will just use the interval calculations
-// use PulseGenerator to manage bool state of pulse duration, per output, to have a 5ms output for each trigger
+// one master phase counts ticks at 960 per quarter note, in 32.32 fixed point, and every output is derived from it
+// with integer math. 1/16 is 240 ticks and triplets are 320 and 640, so they can't drift apart however long it runs
+// outputs are scheduled: each one knows the tick of its next edge, and process() does nothing but advance the clock
+// until the earliest of them comes up. unpatched outputs aren't scheduled at all
+
+// every division an output can play, as a ratio of a quarter note. offset is where the first edge falls after a
+// reset, in ticks at 960 per quarter: straight divisions line up one 1/16 in, the triplets one period in. gates stay
+// open for a 1/16 step, triggers are 1ms. the first fourteen are the outputs' defaults, in panel order. new divisions
+// go at the end, patches store the index
+struct Division {
+	const char* name;
+	uint32_t numerator;
+	uint32_t denominator;
+	uint32_t offset;
+	bool gate;
+};
+
+static const Division divisions[] = {
+	{"1/16", 1, 4, 240, false},
+	{"1/8 Triplet", 1, 3, 320, false},
+	{"1/8", 1, 2, 240, true},
+	{"1/8 Offbeat", 1, 2, 0, true},
+	{"1/4 Triplet", 2, 3, 640, false},
+	{"1/4", 1, 1, 240, true},
+	{"1/4 Offbeat", 1, 1, 720, true},
+	{"1/2", 2, 1, 240, true},
+	{"1/2 Offbeat", 2, 1, 1200, true},
+	{"3/4", 3, 1, 240, true},
+	{"Whole", 4, 1, 240, true},
+	{"5/4", 5, 1, 240, true},
+	{"6/4", 6, 1, 240, true},
+	{"7/4", 7, 1, 240, true},
+	{"1/32", 1, 8, 120, false},
+	{"1/16 Triplet", 1, 6, 160, false},
+	{"1/2 Triplet", 4, 3, 1280, false},
+	{"Dotted 1/8", 3, 4, 240, true},
+	{"Dotted 1/4", 3, 2, 240, true},
+	{"2 bars", 8, 1, 240, true},
+	{"4 bars", 16, 1, 240, true},
+};
+static const int DIVISIONS_LEN = sizeof(divisions) / sizeof(divisions[0]);
 
-struct BaseTrigs : Module {
+// pulses per quarter note the clock input can follow, and how long the follower takes to settle on a new tempo or
+// phase, in seconds
+static const int clockPPQNs[] = {1, 4, 24, 48};
+static const int CLOCK_PPQNS_LEN = 4;
+static const float clockSmoothingTimes[] = {0.f, 0.05f, 0.25f, 1.f};
+
+struct BaseTrigs : ControlRateModule {
 	enum ParamId {
 		TEMPO_MOD_ATTEN_PARAM, 
 		TEMPO_KNOB_PARAM, 
@@ -49,37 +93,37 @@ struct BaseTrigs : Module {
 		_5_4_OUT_OUTPUT, 
 		_6_4_OUT_OUTPUT, 
 		_7_4_OUT_OUTPUT, 
+		ALL_OUT_OUTPUT,
 		OUTPUTS_LEN
 	};
+	// every output before the poly one plays a division. the poly output carries them all, channel 1 is the 1/16 jack
+	// and channel 14 the 7/4 jack, in panel order
+	static const int DIVISION_OUTPUTS_LEN = ALL_OUT_OUTPUT;
 	enum LightId {
 		_1_4_CLOCK_LED_LIGHT,
 		LIGHTS_LEN
 	};
 
-	// these PulseGenerator objects are used to manage the timing of the trig ouput, per output
-	dsp::PulseGenerator pG_1_16; 
-	dsp::PulseGenerator pG_1_8T;
-	dsp::PulseGenerator pG_1_8;
-	dsp::PulseGenerator pG_1_8OB; // OB == offbeat
-	dsp::PulseGenerator pG_1_4T;
-	dsp::PulseGenerator pG_1_4;
-	dsp::PulseGenerator pG_1_4OB;
-	dsp::PulseGenerator pG_1_2;
-	dsp::PulseGenerator pG_1_2OB;
-	dsp::PulseGenerator pG_3_4;
-	dsp::PulseGenerator pG_1_1;
-	dsp::PulseGenerator pG_5_4;
-	dsp::PulseGenerator pG_6_4;
-	dsp::PulseGenerator pG_7_4;
-	
 	//define SchmittTriggers for reset and clock input
 
 	dsp::SchmittTrigger resetTrigger; // reset input and reset button
 	float resetVoltage = 0; // variable to hold reset voltage trigger, so that both reset inputs and reset buttons work the same
 	
 	dsp::SchmittTrigger clockInput; // clock input
-	float currentClockTime = 0.f; 
-	bool firstClock = true;
+
+	// clock follower. every edge is measured, the period is smoothed and the master clock is pulled onto the edges
+	enum ClockSmoothing {
+		CLOCK_SMOOTHING_OFF,
+		CLOCK_SMOOTHING_LIGHT,
+		CLOCK_SMOOTHING_MEDIUM,
+		CLOCK_SMOOTHING_HEAVY,
+		CLOCK_SMOOTHINGS_LEN
+	};
+	int clockPPQN = 1;
+	int clockSmoothing = CLOCK_SMOOTHING_LIGHT;
+	int64_t lastClockFrame = -1; // -1 until the first edge, or after the clock stopped for a minute
+	double clockPeriod = 0.0; // smoothed samples between edges, 0 until two edges came in
+	float phaseCorrection = 1.f; // tempo factor that moves the master clock onto the edges over the next pulse
 
 	dsp::SchmittTrigger tapTempoInput; // tap tempo input
 	float currentTapTime = 0.f; 
@@ -130,17 +174,31 @@ struct BaseTrigs : Module {
 		configOutput(_5_4_OUT_OUTPUT, "5/4 note output");
 		configOutput(_6_4_OUT_OUTPUT, "6/4 note output");
 		configOutput(_7_4_OUT_OUTPUT, "7/4 note output");
+		configOutput(ALL_OUT_OUTPUT, "All divisions, polyphonic");
+
+		for (int i = 0; i < DIVISION_OUTPUTS_LEN; i++) {
+			outputDivisions[i] = i;
+			lastOutputDivisions[i] = i;
+			timings[i] = getTiming(i);
+		}
 	}
 
+
 // Variables to track the clock LED state and timing
 bool ledOn = false;
 float ledTimer = 0.0f;
 const float LED_ON_DURATION = 0.050f; // 50 ms in seconds
 
-// Time tracking for the clocks, where 1/16th is the basis of all non-triplet outputs
-float _1_16_clockTime = 0.f;
-float _1_8T_clockTime = 0.f;
-float _1_4T_clockTime = 0.f;
+// master clock phase in ticks since the last reset, 32.32 fixed point
+static const int PPQN = 960;
+// the phase wraps after this many ticks. 5040 quarters is a whole number of every division's period, so the wrap is
+// never heard, and it keeps the integer part far from overflowing at any tempo
+static const uint32_t CYCLE_TICKS = PPQN * 5040;
+
+uint64_t phase = 0;
+uint64_t phaseIncrement = 0; // ticks per sample, 32.32
+float lastIncrementBPM = 0.f; // bpm and sample rate the increment was worked out for
+float lastIncrementSampleRate = 0.f;
 
 //variables for bpm, starting at 1 to prevent divide by zero errors
 float knobBPM = 115.f; // bpm set by the knob
@@ -149,11 +207,49 @@ float bpm = 115.f; // active bpm that is used for everything
 float lastGoodBPM = 115.f; // for tracking last known good BPM
 float clockOutFallbackBPM = 115.f; // if clock input is unplugged, this bpm takes over
 
-int sixteenthStep = 0;
-int _3_4_BeatTrack = 0; //used for the 3/4 reset
-int _5_4_BeatTrack = 0; //used for the 5/4 reset
-int _6_4_BeatTrack = 0; //used for the 6/4 reset
-int _7_4_BeatTrack = 0; //used for the 7/4 reset
+static const uint32_t STEP_TICKS = PPQN / 4; // a 1/16, the gate length
+
+// the division picked for every output, and its timing in ticks worked out from the table. a width of 0 is a trigger
+int outputDivisions[DIVISION_OUTPUTS_LEN];
+int lastOutputDivisions[DIVISION_OUTPUTS_LEN];
+
+struct Timing {
+	uint32_t period;
+	uint32_t offset;
+	uint32_t width;
+};
+Timing timings[DIVISION_OUTPUTS_LEN];
+
+static Timing getTiming(int division) {
+	const Division& d = divisions[division];
+	Timing timing;
+	timing.period = PPQN * d.numerator / d.denominator;
+	timing.offset = d.offset;
+	timing.width = d.gate ? STEP_TICKS : 0;
+	return timing;
+}
+
+// from the menu and patch loading. the audio thread picks it up at the next control block
+void setOutputDivision(int output, int division) {
+	outputDivisions[output] = division;
+	outputInfos[output]->name = std::string(divisions[division].name) + " output";
+}
+
+static const uint32_t NO_TICK = UINT32_MAX;
+static const int64_t NO_FRAME = INT64_MAX;
+
+// where each output is in its schedule
+struct Schedule {
+	uint32_t nextRise = NO_TICK; // NO_TICK while unpatched
+	uint32_t gateEnd = NO_TICK;
+	int64_t fallFrame = NO_FRAME;
+};
+Schedule schedules[DIVISION_OUTPUTS_LEN];
+bool lastConnected[DIVISION_OUTPUTS_LEN] = {};
+
+// the earliest event of all outputs, so a sample without one costs two compares
+uint32_t nextEventTick = NO_TICK;
+int64_t nextFallFrame = NO_FRAME;
 
 //define reset function
 void resetOutputs(){
@@ -163,58 +259,132 @@ void resetOutputs(){
 	ledTimer = 0.0f;
 	lights[_1_4_CLOCK_LED_LIGHT].setBrightness(0.f);
 	
-	//reset variables that take place in first measure
-	_1_16_clockTime = 0.f;
-	_1_8T_clockTime = 0.f;
-	_1_4T_clockTime = 0.f;
-
-	//reset sixteenthStep
-	sixteenthStep = 0;
-
-	//reset polyrhythmic outputs
-	_3_4_BeatTrack = 0; //used for the 3/4 reset
-	_5_4_BeatTrack = 0; //used for the 5/4 reset
-	_6_4_BeatTrack = 0; //used for the 6/4 reset
-	_7_4_BeatTrack = 0; //used for the 7/4 reset
-
-	//reset all pulses
-
-	pG_1_16.reset(); 
-	pG_1_8T.reset();
-	pG_1_8.reset();
-	pG_1_8OB.reset(); //OB == offbeat
-	pG_1_4T.reset();
-	pG_1_4.reset();
-	pG_1_4OB.reset();
-	pG_1_2.reset();
-	pG_1_2OB.reset();
-	pG_3_4.reset();
-	pG_1_1.reset();
-	pG_5_4.reset();
-	pG_6_4.reset();
-	pG_7_4.reset();
-
-	// turn off all outputs
-    outputs[_1_16_OUT_OUTPUT].setVoltage(0.f);
-    outputs[_1_8T_OUT_OUTPUT].setVoltage(0.f);
-    outputs[_1_8_OUT_OUTPUT].setVoltage(0.f);
-	outputs[_1_8_OFFBEAT_OUT_OUTPUT].setVoltage(0.f);
-    outputs[_1_4T_OUT_OUTPUT].setVoltage(0.f);
-    outputs[_1_4_OUT_OUTPUT].setVoltage(0.f);
-	outputs[_1_4_OFFBEAT_OUT_OUTPUT].setVoltage(0.f);
-    outputs[_1_2_OUT_OUTPUT].setVoltage(0.f);
-	outputs[_1_2_OFFBEAT_OUT_OUTPUT].setVoltage(0.f);
-    outputs[_3_4_OUT_OUTPUT].setVoltage(0.f);
-    outputs[_1_1_OUT_OUTPUT].setVoltage(0.f);
-	outputs[_5_4_OUT_OUTPUT].setVoltage(0.f);
-    outputs[_6_4_OUT_OUTPUT].setVoltage(0.f);
-    outputs[_7_4_OUT_OUTPUT].setVoltage(0.f);
+	//restart the master clock and every output from its first edge. the phase is where it should be now
+	phase = 0;
+	phaseCorrection = 1.f;
+	for (int i = 0; i < DIVISION_OUTPUTS_LEN; i++) {
+		setDivisionVoltage(i, 0.f);
+		if (lastConnected[i]) {
+			scheduleOutput(i, 0);
+		}
+	}
+	updateNextEvent();
+}
 
+// the first edge at or after tick. gate windows already open are skipped, the output starts on its next edge
+void scheduleOutput(int i, uint32_t tick) {
+	const Timing& d = timings[i];
+	uint32_t periods = tick <= d.offset ? 0 : (tick - d.offset + d.period - 1) / d.period;
+	schedules[i].nextRise = d.offset + periods * d.period;
+	schedules[i].gateEnd = NO_TICK;
+	schedules[i].fallFrame = NO_FRAME;
+}
+
+void unscheduleOutput(int i) {
+	schedules[i] = Schedule();
+	setDivisionVoltage(i, 0.f);
+}
+
+// every division goes to its jack and its channel of the poly output
+void setDivisionVoltage(int i, float voltage) {
+	outputs[i].setVoltage(voltage);
+	outputs[ALL_OUT_OUTPUT].setVoltage(voltage, i);
+}
+
+void updateNextEvent() {
+	nextEventTick = NO_TICK;
+	nextFallFrame = NO_FRAME;
+	for (int i = 0; i < DIVISION_OUTPUTS_LEN; i++) {
+		nextEventTick = std::min(nextEventTick, std::min(schedules[i].nextRise, schedules[i].gateEnd));
+		nextFallFrame = std::min(nextFallFrame, schedules[i].fallFrame);
+	}
+}
+
+// runs every edge that is due. only called on samples with something to do
+void processEvents(uint32_t tick, int64_t frame, float sampleRate) {
+	int64_t pulseFrames = std::ceil(0.001f * sampleRate); // 1ms per VCV's voltage standards
+
+	for (int i = 0; i < DIVISION_OUTPUTS_LEN; i++) {
+		Schedule& schedule = schedules[i];
+		const Timing& d = timings[i];
+
+		if (schedule.gateEnd <= tick) {
+			schedule.gateEnd = NO_TICK;
+			schedule.fallFrame = frame + pulseFrames;
+		}
+
+		if (schedule.nextRise <= tick) {
+			setDivisionVoltage(i, 10.f);
+			uint32_t rise = schedule.nextRise;
+			//at extreme tempos several edges can pass in one sample, they make one pulse
+			while (schedule.nextRise <= tick) {
+				rise = schedule.nextRise;
+				schedule.nextRise += d.period;
+			}
+			if (d.width > 0) {
+				schedule.gateEnd = rise + d.width;
+				schedule.fallFrame = NO_FRAME;
+			} else {
+				schedule.fallFrame = frame + pulseFrames;
+			}
+		}
+
+		if (schedule.fallFrame <= frame) {
+			schedule.fallFrame = NO_FRAME;
+			setDivisionVoltage(i, 0.f);
+		}
+	}
+
+	updateNextEvent();
+}
+
+// a clock plugged in or pulled out starts the follower over, so the first edge after a replug doesn't measure the
+// time the cable was out as one long interval
+void onPortChange(const PortChangeEvent& e) override {
+	ControlRateModule::onPortChange(e);
+	if (e.type == Port::INPUT && e.portId == CLOCK_TRIG_IN_INPUT) {
+		clockInput.reset();
+		lastClockFrame = -1;
+		clockPeriod = 0.0;
+		phaseCorrection = 1.f;
+	}
+}
+
+// one edge on the clock input. the period follows the interval by a share that depends on the smoothing time, and the
+// phase error against the nearest pulse of the master clock is corrected by the same share over the next pulse.
+// jitter averages out, and reset and clock edges that arrive together stay lined up like they always did
+void processClockEdge(int64_t frame, float sampleRate) {
+	int64_t interval = frame - lastClockFrame;
+	if (lastClockFrame >= 0 && interval < 0.001f * sampleRate) {
+		return; // a little crazy but trying to let users push it, only bounces are ignored
+	}
+	bool restart = lastClockFrame < 0 || interval > 60.f * sampleRate;
+	lastClockFrame = frame;
+	if (restart) {
+		clockPeriod = 0.0;
+		phaseCorrection = 1.f;
+		return;
+	}
+
+	float smoothing = clockSmoothingTimes[clockSmoothing];
+	double share = smoothing > 0.f ? 1.0 - std::exp(-interval / (smoothing * sampleRate)) : 1.0;
+	if (clockPeriod <= 0.0) {
+		clockPeriod = interval;
+	} else {
+		clockPeriod += share * (interval - clockPeriod);
+	}
+	bpm = 60.f * sampleRate / (clockPeriod * clockPPQN);
+	lastGoodBPM = bpm;
+
+	double ticksPerPulse = (double) PPQN / clockPPQN;
+	double tick = phase / 4294967296.0;
+	double error = std::round(tick / ticksPerPulse) * ticksPerPulse - tick;
+	phaseCorrection = clamp((float) (1.0 + share * error / ticksPerPulse), 0.5f, 2.f);
 }
 
 //make sure tap tempo persists across sessions
 json_t* dataToJson() override {
-    json_t* rootJ = json_object();
+    json_t* rootJ = ControlRateModule::dataToJson();
 
     // Save BPM variables
     json_object_set_new(rootJ, "lastKnobBPM", json_real(lastKnobBPM));
@@ -222,10 +392,20 @@ json_t* dataToJson() override {
     json_object_set_new(rootJ, "lastGoodBPM", json_real(lastGoodBPM));
     json_object_set_new(rootJ, "clockOutFallbackBPM", json_real(clockOutFallbackBPM));
 
+    json_object_set_new(rootJ, "clockPPQN", json_integer(clockPPQN));
+    json_object_set_new(rootJ, "clockSmoothing", json_integer(clockSmoothing));
+
+    json_t* divisionsJ = json_array();
+    for (int i = 0; i < DIVISION_OUTPUTS_LEN; i++)
+        json_array_append_new(divisionsJ, json_integer(outputDivisions[i]));
+    json_object_set_new(rootJ, "outputDivisions", divisionsJ);
+
     return rootJ;
 }
 
 void dataFromJson(json_t* rootJ) override {
+    ControlRateModule::dataFromJson(rootJ);
+
     // Load BPM variables
     json_t* lastKnobBPMJ = json_object_get(rootJ, "lastKnobBPM");
     if (lastKnobBPMJ)
@@ -242,6 +422,28 @@ void dataFromJson(json_t* rootJ) override {
     json_t* clockOutFallbackBPMJ = json_object_get(rootJ, "clockOutFallbackBPM");
     if (clockOutFallbackBPMJ)
         clockOutFallbackBPM = json_real_value(clockOutFallbackBPMJ);
+
+    json_t* clockPPQNJ = json_object_get(rootJ, "clockPPQN");
+    if (clockPPQNJ) {
+        int ppqn = json_integer_value(clockPPQNJ);
+        for (int i = 0; i < CLOCK_PPQNS_LEN; i++) {
+            if (clockPPQNs[i] == ppqn)
+                clockPPQN = ppqn;
+        }
+    }
+
+    json_t* clockSmoothingJ = json_object_get(rootJ, "clockSmoothing");
+    if (clockSmoothingJ)
+        clockSmoothing = clamp((int) json_integer_value(clockSmoothingJ), 0, CLOCK_SMOOTHINGS_LEN - 1);
+
+    json_t* divisionsJ = json_object_get(rootJ, "outputDivisions");
+    if (divisionsJ) {
+        for (int i = 0; i < DIVISION_OUTPUTS_LEN && i < (int) json_array_size(divisionsJ); i++) {
+            int division = json_integer_value(json_array_get(divisionsJ, i));
+            if (division >= 0 && division < DIVISIONS_LEN)
+                setOutputDivision(i, division);
+        }
+    }
 }
 
 
@@ -253,63 +455,74 @@ void dataFromJson(json_t* rootJ) override {
 	// clock input tempo bpm
 
 	if(clockInput.process(inputs[CLOCK_TRIG_IN_INPUT].getVoltage(),0.1f,1.5f)){
-			if(firstClock){
-				firstClock = false;
-				currentClockTime = 0;
-			} else if (currentClockTime > 60.f){
-				firstClock = true;
-				currentClockTime = 0.f;
-			} else if(currentClockTime >= 0.001f){ // a little crazy but trying to let users push it
-				bpm = 60.f / currentClockTime;
-				lastGoodBPM = bpm;
-				firstClock = true;
-			} else{
-				firstClock = true;
-				currentClockTime = 0.f;
+		processClockEdge(args.frame, args.sampleRate);
+	}
+
+		
+	// tap tempo, knob and the clock led run at the control rate. the reset button shares its trigger with the reset input, so it stays per sample
+
+		bool controlTick = processControlRate();
+
+		if(controlTick){
+
+			//a clock that stopped doesn't keep pulling the phase
+			if(phaseCorrection != 1.f && args.frame - lastClockFrame > 2.0 * clockPeriod){
+				phaseCorrection = 1.f;
 			}
-		}
 
-		if(currentClockTime > 70.f){
-			currentClockTime = 0.f;
-		}
-		currentClockTime += args.sampleTime;	
+			//outputs are only scheduled while patched, on their own or through the poly output. a new division starts on
+			//its next edge
+			bool polyConnected = outputs[ALL_OUT_OUTPUT].isConnected();
+			outputs[ALL_OUT_OUTPUT].setChannels(DIVISION_OUTPUTS_LEN);
+			for (int i = 0; i < DIVISION_OUTPUTS_LEN; i++) {
+				bool connected = outputs[i].isConnected() || polyConnected;
+				if (connected != lastConnected[i] || outputDivisions[i] != lastOutputDivisions[i]) {
+					timings[i] = getTiming(outputDivisions[i]);
+					unscheduleOutput(i);
+					if (connected) {
+						scheduleOutput(i, phase >> 32);
+					}
+					lastConnected[i] = connected;
+					lastOutputDivisions[i] = outputDivisions[i];
+					updateNextEvent();
+				}
+			}
 
-		
-	// tap tempo input
-
-		if(tapTempoInput.process(params[TAP_TEMPO_BUTTON_PARAM].getValue(),0.1f,1.5f)){
-			if(firstTap){
-				firstTap = false;
-				currentTapTime = 0;
-			} else if (currentTapTime > 60.f){
-				firstTap = true;
-				currentTapTime = 0.f;
-			} else if(currentTapTime >= 0.01f){
-				bpm = 60.f / currentTapTime;
-				lastGoodBPM = bpm;
-				clockOutFallbackBPM = bpm;
-				firstTap = true;
-			} else{
-				firstTap = true;
-				currentTapTime = 0.f;
+			if(tapTempoInput.process(params[TAP_TEMPO_BUTTON_PARAM].getValue(),0.1f,1.5f)){
+				if(firstTap){
+					firstTap = false;
+					currentTapTime = 0;
+				} else if (currentTapTime > 60.f){
+					firstTap = true;
+					currentTapTime = 0.f;
+				} else if(currentTapTime >= 0.01f){
+					bpm = 60.f / currentTapTime;
+					lastGoodBPM = bpm;
+					clockOutFallbackBPM = bpm;
+					firstTap = true;
+				} else{
+					firstTap = true;
+					currentTapTime = 0.f;
+				}
 			}
-		}
 
-		if(currentTapTime > 70.f){
-			currentTapTime = 0.f;
-		}
-		currentTapTime += args.sampleTime;	
+			if(currentTapTime > 70.f){
+				currentTapTime = 0.f;
+			}
+			currentTapTime += getControlSampleTime(args);
 	
 	
 	
-	// Get the tempo from the knob
-    knobBPM = params[TEMPO_KNOB_PARAM].getValue();
-	if(knobBPM != lastKnobBPM){
-		bpm = knobBPM; 
-		lastGoodBPM = bpm;
-		lastKnobBPM = knobBPM;
-		clockOutFallbackBPM = knobBPM;
-	}
+		// Get the tempo from the knob
+	    knobBPM = params[TEMPO_KNOB_PARAM].getValue();
+		if(knobBPM != lastKnobBPM){
+			bpm = knobBPM; 
+			lastGoodBPM = bpm;
+			lastKnobBPM = knobBPM;
+			clockOutFallbackBPM = knobBPM;
+		}
+
+		} //end of control rate
 
 	if(!inputs[CLOCK_TRIG_IN_INPUT].isConnected()){
 		bpm = clockOutFallbackBPM;
@@ -318,8 +531,8 @@ void dataFromJson(json_t* rootJ) override {
   // Bypass clock generation if bpm is zero. Stop all outputs and lights.
     if (bpm <= 0.f) {
         // Set all outputs to 0V
-        for (int i = 0; i < OUTPUTS_LEN; i++) {
-            outputs[i].setVoltage(0.f);
+        for (int i = 0; i < DIVISION_OUTPUTS_LEN; i++) {
+            setDivisionVoltage(i, 0.f);
         }
         // Turn off all lights
         for (int i = 0; i < LIGHTS_LEN; i++) {
@@ -341,9 +554,11 @@ void dataFromJson(json_t* rootJ) override {
 		}
 
 		//bpm mod via tempo mod input
+		bool tempoModulated = false;
 		if(inputs[TEMP_MOD_IN_INPUT].isConnected()){
 			float tempoModInput = inputs[TEMP_MOD_IN_INPUT].getVoltage();
 			float attenuatedMod = tempoModInput * params[TEMPO_MOD_ATTEN_PARAM].getValue(); // knob goes from 0 to 1
+			tempoModulated = attenuatedMod != 0.f;
 
 			if(inputs[CLOCK_TRIG_IN_INPUT].isConnected()){
 
@@ -369,227 +584,53 @@ void dataFromJson(json_t* rootJ) override {
 			bpm = clamp(bpm, 0.f, 1000000.f);
 		}
 		
-		//declare intervals
-
-		float _1_16_interval = 15.f / bpm;
-		float _1_8T_interval = 20.f / bpm;
-		float _1_4T_interval = 40.f / bpm;
-
-		//declare pulse duration
-		float pulseDuration = 0.001;  // Made this 1ms per VCV's voltage standards. This variable could be used for gate length in the future.
-
- 		// Store sample time
-		float sampleTimeToAdd = args.sampleTime;
-		
-		//sample time to deltaTime for the pulse check process
-		float pulseDeltaTime = sampleTimeToAdd; 
-
-		// Increment clock times
-		_1_16_clockTime += sampleTimeToAdd;
-		_1_8T_clockTime += sampleTimeToAdd;
-		_1_4T_clockTime += sampleTimeToAdd;
-
-	// Evaluate each output
-
-	// Check if the current clock time has passed the interval for the 1/16 note
-
-	if(_1_16_clockTime >= _1_16_interval) {
-    	_1_16_clockTime = fmod(_1_16_clockTime, _1_16_interval);
-
-		pG_1_16.trigger(pulseDuration); //trigger pulse
-		sixteenthStep += 1;
-
-		if(sixteenthStep > 16){ //wraparound
-			sixteenthStep = 1;
-		}
-
-		//try doing these in terms of 16th steps, and updating the trigger / reset in those terms 
-		_3_4_BeatTrack += 1; //used for the 3/4 reset. 1 = 1/16, since it is float
-		_5_4_BeatTrack += 1; //used for the 5/4 reset. 1 = 1/16, since it is float
-		_6_4_BeatTrack += 1; //used for the 6/4 reset. 1 = 1/16, since it is float
-		_7_4_BeatTrack += 1; //used for the 7/4 reset. 1 = 1/16, since it is float
-
-		
-		//wraparound
-		if(_3_4_BeatTrack > 12){ //12 = 3 beats
-			_3_4_BeatTrack = 1;
-		}
-		if(_5_4_BeatTrack > 20){ 
-			_5_4_BeatTrack = 1;
+		//ticks per sample only change with the tempo. while following a clock the phase correction rides on top, unless
+		//the tempo is modulated away from the clock anyway
+		float incrementBPM = bpm;
+		if(inputs[CLOCK_TRIG_IN_INPUT].isConnected() && !tempoModulated){
+			incrementBPM *= phaseCorrection;
 		}
-		if(_6_4_BeatTrack > 24){
-			_6_4_BeatTrack = 1;
+		if(incrementBPM != lastIncrementBPM || args.sampleRate != lastIncrementSampleRate){
+			phaseIncrement = (uint64_t) ((double) incrementBPM / 60.0 * PPQN / args.sampleRate * 4294967296.0);
+			lastIncrementBPM = incrementBPM;
+			lastIncrementSampleRate = args.sampleRate;
 		}
-		if(_7_4_BeatTrack > 28){
-			_7_4_BeatTrack = 1;
-		}
-
-
-	} 
-
-	//check if 1/16 pulse is active. if so, set output high. if not, set output low.
-
-	if(pG_1_16.process(pulseDeltaTime)){
-		outputs[_1_16_OUT_OUTPUT].setVoltage(10.f);
-	} else {
-		outputs[_1_16_OUT_OUTPUT].setVoltage(0.f);
-	}
-
-	//same idea as above, but for 1/8th triplets, which will also drive 1/4 triplets
-	
-	if (_1_8T_clockTime >= _1_8T_interval) {
-    	_1_8T_clockTime = fmod(_1_8T_clockTime, _1_8T_interval);
-
-		pG_1_8T.trigger(pulseDuration); //trigger pulse
-	} 
-
-	//check if 1/8T pulse is active. if so, set output high. if not, set output low.
-
-	if(pG_1_8T.process(pulseDeltaTime)){
-		outputs[_1_8T_OUT_OUTPUT].setVoltage(10.f);
-	} else {
-		outputs[_1_8T_OUT_OUTPUT].setVoltage(0.f);
-	}
-
-
-	//using 16th step counter, trigger other outputs
-
-	if(sixteenthStep % 2 == 1){ // 1/8th note
-		pG_1_8.trigger(pulseDuration);
-	}
-	if(pG_1_8.process(pulseDeltaTime)){
-		outputs[_1_8_OUT_OUTPUT].setVoltage(10.f);
-	} else{
-		outputs[_1_8_OUT_OUTPUT].setVoltage(0.f);
-	}
-
-	if(sixteenthStep % 2 == 0){ // 1/8th note, offbeat
-		pG_1_8OB.trigger(pulseDuration);
-	}
-	if(pG_1_8OB.process(pulseDeltaTime)){
-		outputs[_1_8_OFFBEAT_OUT_OUTPUT].setVoltage(10.f);
-	} else{
-		outputs[_1_8_OFFBEAT_OUT_OUTPUT].setVoltage(0.f);
-	}
 
-	
-	//need to use interval method for 1/4T
-	if(_1_4T_clockTime >= _1_4T_interval) {
-    	_1_4T_clockTime = fmod(_1_4T_clockTime,_1_4T_interval);
-		pG_1_4T.trigger(pulseDuration);
-	}
-	if(pG_1_4T.process(pulseDeltaTime)){
-		outputs[_1_4T_OUT_OUTPUT].setVoltage(10.f);
-	} else{
-		outputs[_1_4T_OUT_OUTPUT].setVoltage(0.f);
-	}
-
-	
-	if(sixteenthStep == 1 || sixteenthStep == 5 || sixteenthStep == 9 || sixteenthStep == 13) {
-    	pG_1_4.trigger(pulseDuration);
-		 // Start the LED timer
-  		ledOn = true;
-        ledTimer = LED_ON_DURATION;
-	}
-	if(pG_1_4.process(pulseDeltaTime)){
-		outputs[_1_4_OUT_OUTPUT].setVoltage(10.f);
-	} else{
-		outputs[_1_4_OUT_OUTPUT].setVoltage(0.f);
-	}
-
-
-    // Update the LED state based on the timer
-    if (ledOn) {
-        ledTimer -= sampleTimeToAdd;
-		
-        if (ledTimer <= 0.0f) {
-            ledOn = false;  // Turn off LED after 50 ms
-        }
-    }
-
-	lights[_1_4_CLOCK_LED_LIGHT].setBrightness(ledOn ? 1.f : 0.f);
-
-    //continue with outputs
-
-	//1/4 offbeat
-	if(sixteenthStep == 3 || sixteenthStep == 7 || sixteenthStep == 11 || sixteenthStep == 15) {
-    	pG_1_4OB.trigger(pulseDuration);
-	}	
-	if(pG_1_4OB.process(pulseDeltaTime)){
-		outputs[_1_4_OFFBEAT_OUT_OUTPUT].setVoltage(10.f);
-	} else{
-		outputs[_1_4_OFFBEAT_OUT_OUTPUT].setVoltage(0.f);
-	}	
-	
-	// 1/2 output
-	if(sixteenthStep == 1 || sixteenthStep == 9) {
-    	pG_1_2.trigger(pulseDuration);
-	}	
-	if(pG_1_2.process(pulseDeltaTime)){
-		outputs[_1_2_OUT_OUTPUT].setVoltage(10.f);
-	} else{
-		outputs[_1_2_OUT_OUTPUT].setVoltage(0.f);
-	}	
-
-	// 1/2 offbeat output
-
-	if(sixteenthStep == 5 || sixteenthStep == 13) {
-    	pG_1_2OB.trigger(pulseDuration);
-	}	
-	if(pG_1_2OB.process(pulseDeltaTime)){
-		outputs[_1_2_OFFBEAT_OUT_OUTPUT].setVoltage(10.f);
-	} else{
-		outputs[_1_2_OFFBEAT_OUT_OUTPUT].setVoltage(0.f);
-	}	
-
-	// 3/4 output
-	if(_3_4_BeatTrack == 1){ 
-		pG_3_4.trigger(pulseDuration);
-	}
-	if(pG_3_4.process(pulseDeltaTime)){
-		outputs[_3_4_OUT_OUTPUT].setVoltage(10.f);
-	} else{
-		outputs[_3_4_OUT_OUTPUT].setVoltage(0.f);
-	}
-
-	// 1/1 output
-	if(sixteenthStep == 1) {
-    	pG_1_1.trigger(pulseDuration);
-	}	
-	if(pG_1_1.process(pulseDeltaTime)){
-		outputs[_1_1_OUT_OUTPUT].setVoltage(10.f);
-	} else{
-		outputs[_1_1_OUT_OUTPUT].setVoltage(0.f);
-	}
-
-	// 5/4 output
-	if(_5_4_BeatTrack == 1){ 
-		pG_5_4.trigger(pulseDuration);
-	}
-	if(pG_5_4.process(pulseDeltaTime)){
-		outputs[_5_4_OUT_OUTPUT].setVoltage(10.f);
-	} else{
-		outputs[_5_4_OUT_OUTPUT].setVoltage(0.f);
-	}
+		// Advance the master clock, and run the outputs' edges when one is due
+		phase += phaseIncrement;
+		uint32_t tick = phase >> 32;
+		if(tick >= nextEventTick || args.frame >= nextFallFrame){
+			processEvents(tick, args.frame, args.sampleRate);
+		}
 
-	// 6/4 output
-	if(_6_4_BeatTrack == 1){
-		pG_6_4.trigger(pulseDuration);
-	}
-	if(pG_6_4.process(pulseDeltaTime)){
-		outputs[_6_4_OUT_OUTPUT].setVoltage(10.f);
-	} else{
-		outputs[_6_4_OUT_OUTPUT].setVoltage(0.f);
-	}
+		// the wrap moves every scheduled edge back with it
+		if(tick >= CYCLE_TICKS){
+			phase -= (uint64_t) CYCLE_TICKS << 32;
+			tick -= CYCLE_TICKS;
+			for (int i = 0; i < DIVISION_OUTPUTS_LEN; i++) {
+				if (schedules[i].nextRise != NO_TICK) {
+					schedules[i].nextRise -= CYCLE_TICKS;
+				}
+				if (schedules[i].gateEnd != NO_TICK) {
+					schedules[i].gateEnd -= CYCLE_TICKS;
+				}
+			}
+			updateNextEvent();
+		}
 
-	// 7/4 output
-	if(_7_4_BeatTrack == 1){ 
-		pG_7_4.trigger(pulseDuration);
-	}
-	if(pG_7_4.process(pulseDeltaTime)){
-		outputs[_7_4_OUT_OUTPUT].setVoltage(10.f);
-	} else{
-		outputs[_7_4_OUT_OUTPUT].setVoltage(0.f);
+	// the LED lights through the 1/16 step of every quarter note and 50ms past it, at the control rate, whatever
+	// division the outputs play
+	if(controlTick){
+		if(tick >= STEP_TICKS && (tick - STEP_TICKS) % PPQN < STEP_TICKS){
+			ledOn = true;
+			ledTimer = LED_ON_DURATION;
+		} else if(ledOn){
+			ledTimer -= getControlSampleTime(args);
+			if (ledTimer <= 0.0f) {
+				ledOn = false;  // Turn off LED after 50 ms
+			}
+		}
+		lights[_1_4_CLOCK_LED_LIGHT].setBrightness(ledOn ? 1.f : 0.f);
 	}
 
 }
@@ -631,8 +672,47 @@ struct BaseTrigsWidget : ModuleWidget {
 		addOutput(createOutputCentered<CL1362Port>(mm2px(Vec(7.353, 89.75)), module, BaseTrigs::_6_4_OUT_OUTPUT));
 		addOutput(createOutputCentered<CL1362Port>(mm2px(Vec(20.32, 89.75)), module, BaseTrigs::_7_4_OUT_OUTPUT));
 
+		addOutput(createOutputCentered<CL1362Port>(mm2px(Vec(33.287, 117.797)), module, BaseTrigs::ALL_OUT_OUTPUT));
+
 		addChild(createLightCentered<MediumLight<RedLight>>(mm2px(Vec(26.804, 30.25)), module, BaseTrigs::_1_4_CLOCK_LED_LIGHT));
 	}
+
+	void appendContextMenu(Menu* menu) override {
+		BaseTrigs* module = getModule<BaseTrigs>();
+
+		std::vector<std::string> names;
+		for (int i = 0; i < DIVISIONS_LEN; i++)
+			names.push_back(divisions[i].name);
+
+		menu->addChild(new MenuSeparator);
+		menu->addChild(createIndexSubmenuItem("Clock input", {"1 PPQN (quarter notes)", "4 PPQN (1/16 notes)", "24 PPQN", "48 PPQN"},
+			[=]() {
+				for (int i = 0; i < CLOCK_PPQNS_LEN; i++) {
+					if (clockPPQNs[i] == module->clockPPQN)
+						return i;
+				}
+				return 0;
+			},
+			[=](size_t i) {module->clockPPQN = clockPPQNs[i];}
+		));
+		menu->addChild(createIndexPtrSubmenuItem("Clock smoothing", {"Off", "Light (50ms)", "Medium (250ms)", "Heavy (1s)"}, &module->clockSmoothing));
+
+		//one submenu per jack, named after its panel label
+		menu->addChild(createSubmenuItem("Output divisions", "", [=](Menu* menu) {
+			for (int i = 0; i < BaseTrigs::DIVISION_OUTPUTS_LEN; i++) {
+				menu->addChild(createIndexSubmenuItem(std::string(divisions[i].name) + " jack", names,
+					[=]() {return module->outputDivisions[i];},
+					[=](size_t division) {module->setOutputDivision(i, division);}
+				));
+			}
+			menu->addChild(createMenuItem("Reset to panel", "", [=]() {
+				for (int i = 0; i < BaseTrigs::DIVISION_OUTPUTS_LEN; i++)
+					module->setOutputDivision(i, i);
+			}));
+		}));
+
+		appendControlRateMenu(menu, module);
+	}
 };
 
 
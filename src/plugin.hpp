@@ -15,3 +15,70 @@ extern Plugin* pluginInstance;
  extern Model* modelSoloMixer;
  extern Model* modelBaseOsc;
 
+
+
+// control rate layer shared by the modules. param polling, button edges and lights run once every controlDivision
+// samples, audio keeps running every sample. the divisor is picked in the context menu and saved with the patch
+static const int controlDivisions[] = {16, 32, 64};
+static const int CONTROL_DIVISIONS_LEN = 3;
+
+struct ControlRateModule : Module {
+	int controlDivision = 16;
+	dsp::ClockDivider controlDivider;
+
+	// true once per control block. a divisor picked in the menu is applied here, on the audio thread, and starts a
+	// new block straight away so nothing keeps ramping with the old block length. the divider starts out at 1, so the
+	// very first sample is a control block too and modules never run on unset controls
+	bool processControlRate() {
+		if (controlDivider.getDivision() != (uint32_t) controlDivision) {
+			controlDivider.setDivision(controlDivision);
+			controlDivider.reset();
+			return true;
+		}
+		return controlDivider.process();
+	}
+
+	// time between two control blocks, for timers that run at the control rate
+	float getControlSampleTime(const ProcessArgs& args) {
+		return args.sampleTime * controlDivision;
+	}
+
+	// turns a per sample smoothing factor into the one that gives the same response once per control block
+	float getControlSmoothing(float perSampleFactor) {
+		return 1.f - std::pow(1.f - perSampleFactor, (float) controlDivision);
+	}
+
+	json_t* dataToJson() override {
+		json_t* rootJ = json_object();
+		json_object_set_new(rootJ, "controlDivision", json_integer(controlDivision));
+		return rootJ;
+	}
+
+	void dataFromJson(json_t* rootJ) override {
+		json_t* controlDivisionJ = json_object_get(rootJ, "controlDivision");
+		if (controlDivisionJ) {
+			int division = json_integer_value(controlDivisionJ);
+			for (int i = 0; i < CONTROL_DIVISIONS_LEN; i++) {
+				if (controlDivisions[i] == division)
+					controlDivision = division;
+			}
+		}
+	}
+};
+
+// context menu entry for the control rate, shared by every module widget
+inline void appendControlRateMenu(Menu* menu, ControlRateModule* module) {
+	menu->addChild(new MenuSeparator);
+	menu->addChild(createIndexSubmenuItem("Control rate", {"Every 16 samples", "Every 32 samples", "Every 64 samples"},
+		[=]() {
+			for (int i = 0; i < CONTROL_DIVISIONS_LEN; i++) {
+				if (controlDivisions[i] == module->controlDivision)
+					return i;
+			}
+			return 0;
+		},
+		[=](size_t i) {
+			module->controlDivision = controlDivisions[i];
+		}
+	));
+}